@@ -15,20 +15,55 @@ TEMPLATE = app
 SOURCES += src/main.cpp\
         src/overlaywidget.cpp \
 		src/overlaycontroller.cpp \
-		src/audiomanager/audiomanagerwindows.cpp
+		src/pttinputthread.cpp \
+		src/audiocommandworker.cpp \
+		src/audiomanager.cpp \
+		src/deadlinescheduler.cpp \
+		src/latencytracer.cpp \
+		src/pttpredicate.cpp \
+		src/inputrecording.cpp \
+		src/overlayrenderer.cpp \
+		src/framescheduler.cpp \
+		src/overlayrenderer/overlayrenderergl.cpp \
+		src/overlayrenderer/overlayrendererraster.cpp \
+		src/audiomanager/audiomanagerfake.cpp
 
 
 HEADERS  += src/overlaywidget.h \
 		src/overlaycontroller.h \
+		src/pttinputthread.h \
+		src/audiocommandworker.h \
+		src/deadlinescheduler.h \
+		src/latencytracer.h \
+		src/pttpredicate.h \
+		src/inputrecording.h \
+		src/triplebuffer.h \
 		src/logging.h \
 		src/audiomanager.h \
-		src/audiomanager/audiomanagerwindows.h
+		src/overlayrenderer.h \
+		src/framescheduler.h \
+		src/overlayrenderer/overlayrenderergl.h \
+		src/overlayrenderer/overlayrendererraster.h \
+		src/audiomanager/audiomanagerfake.h
 
 FORMS    += ui/overlaywidget.ui
 
 INCLUDEPATH += third-party/openvr/include \
 			third-party/easylogging++
 
-LIBS += -Lthird-party/openvr/lib/win64 -lopenvr_api
+win32 {
+	SOURCES += src/audiomanager/audiomanagerwindows.cpp
+	HEADERS += src/audiomanager/audiomanagerwindows.h
+	LIBS += -Lthird-party/openvr/lib/win64 -lopenvr_api -lole32 -lwinmm
+	DESTDIR = bin/win64
+}
 
-DESTDIR = bin/win64
+unix:!macx {
+	SOURCES += src/audiomanager/audiomanageralsa.cpp \
+		src/audiomanager/audiomanagerpulse.cpp
+	HEADERS += src/audiomanager/audiomanageralsa.h \
+		src/audiomanager/audiomanagerpulse.h
+	CONFIG += c++11
+	LIBS += -Lthird-party/openvr/lib/linux64 -lopenvr_api -lasound -lpulse
+	DESTDIR = bin/linux64
+}
@@ -0,0 +1,141 @@
+#include "audiocommandworker.h"
+#include "logging.h"
+
+#ifdef _WIN32
+	#include <windows.h>
+#endif
+
+
+// application namespace
+namespace miccontrol {
+
+AudioCommandWorker::AudioCommandWorker(std::shared_ptr<AudioManager> audioManager) : audioManager(audioManager) {
+	thread = std::thread(&AudioCommandWorker::run, this);
+	if (audioManager) {
+		audioManager->setDeviceChangedHandler([this]() {
+			rebindDevice();
+		});
+	}
+}
+
+
+AudioCommandWorker::~AudioCommandWorker() {
+	if (audioManager) {
+		audioManager->setDeviceChangedHandler(nullptr);
+	}
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopRequested = true;
+	}
+	condition.notify_one();
+	thread.join();
+	if (volumeRequestCount) {
+		LOG(INFO) << "Coalesced " << volumeRequestCount << " volume requests into " << volumeWriteCount << " writes.";
+	}
+}
+
+
+std::shared_future<bool> AudioCommandWorker::setMuted(bool mute, Completion completion) {
+	return postCommand(mutex, condition, muteMailbox, mute, completion);
+}
+
+
+std::shared_future<bool> AudioCommandWorker::setMasterVolume(float value, Completion completion) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		volumeRequestCount++;
+	}
+	return postCommand(mutex, condition, volumeMailbox, value, completion);
+}
+
+
+void AudioCommandWorker::flushMasterVolume() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!volumeMailbox.pending) {
+			return; // a left-over flag would let the next unrelated write skip the rate limit
+		}
+		volumeFlushRequested = true;
+	}
+	condition.notify_one();
+}
+
+
+void AudioCommandWorker::setVolumeWriteInterval(Clock::duration interval) {
+	std::lock_guard<std::mutex> lock(mutex);
+	volumeWriteInterval = interval;
+}
+
+
+void AudioCommandWorker::rebindDevice() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		rebindRequested = true;
+	}
+	condition.notify_one();
+}
+
+
+// Called with the lock held, releases it while the device is rebound.
+void AudioCommandWorker::rebind(std::unique_lock<std::mutex>& lock) {
+	rebindRequested = false;
+	bool reapplyMuted = hasRequestedMuted && !muteMailbox.pending;
+	bool muted = requestedMuted;
+	bool reapplyVolume = hasRequestedVolume && !volumeMailbox.pending;
+	float volume = requestedVolume;
+	lock.unlock();
+
+	if (audioManager && audioManager->rebindDevice()) {
+		LOG(INFO) << "Audio device changed, re-applying mute and volume state.";
+		// pending commands are executed right after this anyway
+		if (reapplyMuted && !audioManager->setMuted(muted)) {
+			LOG(WARNING) << "Could not re-apply mute state to the new audio device.";
+		}
+		if (reapplyVolume && !audioManager->setMasterVolume(volume)) {
+			LOG(WARNING) << "Could not re-apply volume to the new audio device.";
+		}
+	}
+
+	lock.lock();
+}
+
+
+void AudioCommandWorker::run() {
+#ifdef _WIN32
+	CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+#endif
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		if (rebindRequested) {
+			rebind(lock);
+		} else if (muteMailbox.pending) {
+			// mute first, that's the latency critical one
+			hasRequestedMuted = true;
+			requestedMuted = muteMailbox.value;
+			executeCommand(lock, muteMailbox, [this](bool mute) {
+				return audioManager && audioManager->isValid() && audioManager->setMuted(mute);
+			});
+		} else if (volumeMailbox.pending && (volumeFlushRequested || stopRequested || Clock::now() >= nextVolumeWrite)) {
+			volumeFlushRequested = false;
+			volumeWriteCount++;
+			hasRequestedVolume = true;
+			requestedVolume = volumeMailbox.value;
+			executeCommand(lock, volumeMailbox, [this](float value) {
+				return audioManager && audioManager->isValid() && audioManager->setMasterVolume(value);
+			});
+			nextVolumeWrite = Clock::now() + volumeWriteInterval;
+		} else if (stopRequested) {
+			break;
+		} else if (volumeMailbox.pending) {
+			condition.wait_until(lock, nextVolumeWrite);
+		} else {
+			condition.wait(lock);
+		}
+	}
+	lock.unlock();
+#ifdef _WIN32
+	CoUninitialize();
+#endif
+}
+
+} // namespace miccontrol
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "audiomanager.h"
+
+
+// application namespace
+namespace miccontrol {
+
+// called on the worker thread (or on the posting thread when superseded, so it must not take locks held while posting),
+// callTime is when the command started (only meaningful on success)
+typedef std::function<void(bool success, std::chrono::steady_clock::time_point callTime)> CommandCompletion;
+
+// Latest-wins slot for the commands of one property, shared by everything that executes audio commands on its own
+// thread. Only accessed with the owner's mutex held, through postCommand() and executeCommand().
+template<typename T>
+struct CommandMailbox {
+	bool pending = false;
+	T value = T();
+	std::vector<std::promise<bool>> promises;
+	std::vector<CommandCompletion> completions;
+};
+
+// Replaces the command that has not started yet (it completes with false) and wakes up the owner's thread.
+template<typename T>
+std::shared_future<bool> postCommand(std::mutex& mutex, std::condition_variable& condition, CommandMailbox<T>& mailbox, T value,
+		CommandCompletion completion = nullptr) {
+	std::vector<std::promise<bool>> supersededPromises;
+	std::vector<CommandCompletion> supersededCompletions;
+	std::promise<bool> promise;
+	std::shared_future<bool> future = promise.get_future().share();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (mailbox.pending) {
+			supersededPromises.swap(mailbox.promises);
+			supersededCompletions.swap(mailbox.completions);
+		}
+		mailbox.pending = true;
+		mailbox.value = value;
+		mailbox.promises.push_back(std::move(promise));
+		if (completion) {
+			mailbox.completions.push_back(completion);
+		}
+	}
+	condition.notify_one();
+	// completions first, so that a caller waiting on a future knows that its completion has run
+	for (auto& c : supersededCompletions) {
+		c(false, std::chrono::steady_clock::time_point());
+	}
+	for (auto& p : supersededPromises) {
+		p.set_value(false);
+	}
+	return future;
+}
+
+// Called with the lock held, releases it while the command is running. The command returns whether it succeeded.
+template<typename T, typename Command>
+void executeCommand(std::unique_lock<std::mutex>& lock, CommandMailbox<T>& mailbox, Command command) {
+	T value = mailbox.value;
+	std::vector<std::promise<bool>> promises;
+	std::vector<CommandCompletion> completions;
+	promises.swap(mailbox.promises);
+	completions.swap(mailbox.completions);
+	mailbox.pending = false;
+	lock.unlock();
+
+	auto callTime = std::chrono::steady_clock::now();
+	bool success = command(value);
+	for (auto& c : completions) {
+		c(success, callTime);
+	}
+	for (auto& p : promises) {
+		p.set_value(success);
+	}
+
+	lock.lock();
+}
+
+// Executes AudioManager calls on a dedicated thread so that callers never block on the audio stack.
+// Each property has a latest-wins mailbox: a command that has not started yet is replaced by a newer one for the
+// same property, the replaced command completes with false. Volume writes are additionally rate limited, so that
+// dragging a slider only sends the most recent value once per volume write interval.
+// When the audio manager reports a device change, the worker rebinds it before any other command and re-applies the
+// most recently requested mute/volume state to the new device.
+class AudioCommandWorker {
+public:
+	typedef std::chrono::steady_clock Clock;
+	typedef CommandCompletion Completion;
+
+private:
+	std::shared_ptr<AudioManager> audioManager;
+	std::mutex mutex;
+	std::condition_variable condition;
+	CommandMailbox<bool> muteMailbox;
+	CommandMailbox<float> volumeMailbox;
+	Clock::duration volumeWriteInterval = std::chrono::milliseconds(10);
+	Clock::time_point nextVolumeWrite;
+	bool volumeFlushRequested = false;
+	bool rebindRequested = false;
+	bool hasRequestedMuted = false;
+	bool requestedMuted = false;
+	bool hasRequestedVolume = false;
+	float requestedVolume = 0.0f;
+	uint64_t volumeRequestCount = 0;
+	uint64_t volumeWriteCount = 0;
+	bool stopRequested = false;
+	std::thread thread;
+
+public:
+	AudioCommandWorker(std::shared_ptr<AudioManager> audioManager);
+	// executes all pending commands before returning
+	~AudioCommandWorker();
+
+	std::shared_future<bool> setMuted(bool mute, Completion completion = nullptr);
+	std::shared_future<bool> setMasterVolume(float value, Completion completion = nullptr);
+	// writes a pending volume right away instead of waiting for the rate limit
+	void flushMasterVolume();
+	void setVolumeWriteInterval(Clock::duration interval);
+	// thread-safe and non-blocking, the rebind happens on the worker thread
+	void rebindDevice();
+
+	AudioManager* getAudioManager() {
+		return audioManager.get();
+	}
+
+private:
+	void rebind(std::unique_lock<std::mutex>& lock);
+	void run();
+};
+
+} // namespace miccontrol
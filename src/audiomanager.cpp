@@ -0,0 +1,67 @@
+#include "audiomanager.h"
+
+
+// application namespace
+namespace miccontrol {
+
+AudioDeviceSelection AudioDeviceSelection::parse(const std::string& value) {
+	AudioDeviceSelection selection;
+	if (value.empty() || value == "default") {
+		selection.mode = MODE_DEFAULT;
+	} else if (value == "all") {
+		selection.mode = MODE_ALL;
+	} else {
+		selection.mode = MODE_LIST;
+		size_t start = 0;
+		while (start <= value.size()) {
+			size_t end = value.find(';', start);
+			if (end == std::string::npos) {
+				end = value.size();
+			}
+			if (end > start) {
+				selection.ids.push_back(value.substr(start, end - start));
+			}
+			start = end + 1;
+		}
+		if (selection.ids.empty()) {
+			selection.mode = MODE_DEFAULT;
+		}
+	}
+	return selection;
+}
+
+void AudioManager::updateCachedState(bool muted, float masterVolume) {
+	std::lock_guard<std::mutex> lock(cachedStateMutex);
+	setCachedState(packState(muted, masterVolume));
+}
+
+void AudioManager::updateCachedMuted(bool muted) {
+	std::lock_guard<std::mutex> lock(cachedStateMutex);
+	setCachedState(packState(muted, unpackMasterVolume(cachedState)));
+}
+
+void AudioManager::updateCachedMasterVolume(float masterVolume) {
+	std::lock_guard<std::mutex> lock(cachedStateMutex);
+	setCachedState(packState(cachedState >> 32, masterVolume));
+}
+
+// Requires cachedStateMutex to be held, so the handler sees the changes in order.
+void AudioManager::setCachedState(uint64_t state) {
+	if (cachedState.exchange(state) != state && stateChangedHandler) {
+		stateChangedHandler(state >> 32, unpackMasterVolume(state));
+	}
+}
+
+void AudioManager::setDeviceChangedHandler(std::function<void()> handler) {
+	std::lock_guard<std::mutex> lock(deviceChangedMutex);
+	deviceChangedHandler = handler;
+}
+
+void AudioManager::notifyDeviceChanged() {
+	std::lock_guard<std::mutex> lock(deviceChangedMutex);
+	if (deviceChangedHandler) {
+		deviceChangedHandler();
+	}
+}
+
+}
@@ -1,16 +1,62 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
 
 // application namespace
 namespace miccontrol {
 
 class OverlayController;
 
+// Which capture devices a backend controls: the default one, all active ones or a list of backend specific IDs.
+struct AudioDeviceSelection {
+	enum Mode {
+		MODE_DEFAULT = 0,
+		MODE_ALL = 1,
+		MODE_LIST = 2,
+	};
+
+	Mode mode = MODE_DEFAULT;
+	std::vector<std::string> ids;
+
+	// "" or "default", "all", or a ';'-separated list of IDs
+	static AudioDeviceSelection parse(const std::string& value);
+};
+
 class AudioManager
 {
+private:
+	std::atomic<uint64_t> cachedState; // muted in the upper half, the master volume's bits in the lower, so readers get a consistent pair
+	std::mutex cachedStateMutex; // updates and their notifications happen in the same order
+	std::mutex deviceChangedMutex;
+	std::function<void()> deviceChangedHandler;
+	std::function<void(bool, float)> stateChangedHandler;
+
+protected:
+	OverlayController* controller = nullptr;
+	AudioDeviceSelection deviceSelection;
+
 public:
+	AudioManager() : cachedState(packState(false, 1.0f)) {}
 	virtual ~AudioManager() {};
 
+	// must be called before init()
+	void setDeviceSelection(const AudioDeviceSelection& selection) {
+		deviceSelection = selection;
+	}
+	// must be called before init(), the handler is called from backend threads whenever the cached state changed
+	void setStateChangedHandler(std::function<void(bool muted, float masterVolume)> handler) {
+		stateChangedHandler = handler;
+	}
+
+	// When more than one device is selected the setters apply to all of them, the getters and the cached state
+	// refer to the primary device (the default device if it is selected, otherwise the first one).
 	virtual void init(OverlayController* controller) = 0;
 	virtual bool isValid() = 0;
 
@@ -19,7 +65,51 @@ public:
 
 	virtual float getMasterVolume() = 0;
 	virtual bool setMasterVolume(float value) = 0;
+
+	// Binds to the current default device, returns true when the device changed and the mute/volume state needs to be
+	// re-applied. Called on the audio command worker thread after the backend signalled a device change.
+	virtual bool rebindDevice() {
+		return false;
+	}
+	// The handler is called from backend threads and must not block.
+	void setDeviceChangedHandler(std::function<void()> handler);
+
+	// Last known device state as reported by the backend's change notifications, never blocks.
+	bool getCachedMuted() {
+		return cachedState >> 32;
+	}
+	float getCachedMasterVolume() {
+		return unpackMasterVolume(cachedState);
+	}
+	void getCachedState(bool& muted, float& masterVolume) {
+		uint64_t state = cachedState;
+		muted = state >> 32;
+		masterVolume = unpackMasterVolume(state);
+	}
+
+protected:
+	// To be called by the backends whenever the device state changed (from any thread).
+	void updateCachedState(bool muted, float masterVolume);
+	// same, when only one of them is known to have changed
+	void updateCachedMuted(bool muted);
+	void updateCachedMasterVolume(float masterVolume);
+	// To be called by the backends when the default device changed or the current one went away (from any thread).
+	void notifyDeviceChanged();
+
+private:
+	static uint64_t packState(bool muted, float masterVolume) {
+		uint32_t bits;
+		std::memcpy(&bits, &masterVolume, sizeof(bits));
+		return ((uint64_t)muted << 32) | bits;
+	}
+	static float unpackMasterVolume(uint64_t state) {
+		uint32_t bits = (uint32_t)state;
+		float masterVolume;
+		std::memcpy(&masterVolume, &bits, sizeof(masterVolume));
+		return masterVolume;
+	}
+	// Requires cachedStateMutex to be held.
+	void setCachedState(uint64_t state);
 };
 
 }
-
@@ -0,0 +1,322 @@
+#include "audiomanageralsa.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <QEvent>
+#include "../logging.h"
+
+
+// application namespace
+namespace miccontrol {
+
+// Hooks into the socket activation event directly, the activated() signal is overloaded differently across Qt5 versions.
+class MixerPollNotifier : public QSocketNotifier {
+private:
+	std::function<void()> handler;
+
+public:
+	MixerPollNotifier(int fd, std::function<void()> handler) : QSocketNotifier(fd, QSocketNotifier::Read), handler(handler) {}
+
+protected:
+	bool event(QEvent* e) override {
+		if (e->type() == QEvent::SockAct) {
+			handler();
+			return true;
+		}
+		return QSocketNotifier::event(e);
+	}
+};
+
+
+AudioManagerAlsa::~AudioManagerAlsa() {
+	reopenTimer.reset();
+	pollNotifiers.clear();
+	closeMixers();
+}
+
+void AudioManagerAlsa::init(OverlayController* controller) {
+	this->controller = controller;
+	reopenTimer.reset(new QTimer());
+	reopenTimer->setSingleShot(true);
+	QObject::connect(reopenTimer.get(), &QTimer::timeout, [this]() {
+		reopenMixers();
+	});
+	if (!openMixers()) {
+		reopenTimer->start(reopenInterval);
+	}
+}
+
+bool AudioManagerAlsa::rebindDevice() {
+	return deviceChanged.exchange(false);
+}
+
+bool AudioManagerAlsa::openMixers(bool logErrors) {
+	std::unique_lock<std::mutex> lock(mixerMutex);
+	mixerLost = false;
+	if (deviceSelection.mode == AudioDeviceSelection::MODE_ALL) {
+		int card = -1;
+		while (snd_card_next(&card) >= 0 && card >= 0) {
+			openMixer("hw:" + std::to_string(card), std::vector<std::string>(), logErrors);
+		}
+	} else if (deviceSelection.mode == AudioDeviceSelection::MODE_LIST) {
+		// one mixer per device, keeping the order of the list
+		std::vector<std::pair<std::string, std::vector<std::string>>> devices;
+		for (auto& id : deviceSelection.ids) {
+			size_t pos = id.find('/');
+			std::string device = pos == std::string::npos ? mixerDevice : id.substr(0, pos);
+			std::string element = pos == std::string::npos ? id : id.substr(pos + 1);
+			auto it = std::find_if(devices.begin(), devices.end(), [&device](const std::pair<std::string, std::vector<std::string>>& d) {
+				return d.first == device;
+			});
+			if (it == devices.end()) {
+				devices.push_back(std::make_pair(device, std::vector<std::string>(1, element)));
+			} else {
+				it->second.push_back(element);
+			}
+		}
+		for (auto& d : devices) {
+			openMixer(d.first, d.second, logErrors);
+		}
+	} else {
+		openMixer(mixerDevice, std::vector<std::string>(1, elementName), logErrors);
+		if (mixers.empty()) {
+			openMixer(mixerDevice, std::vector<std::string>(), false);
+			if (!mixers.empty()) {
+				mixers[0].controls.resize(1);
+				LOG_IF(logErrors, WARNING) << "Could not find ALSA mixer element \"" << elementName << "\", falling back to \""
+					<< snd_mixer_selem_get_name(mixers[0].controls[0].element) << "\".";
+			}
+		}
+	}
+	if (mixers.empty()) {
+		LOG_IF(logErrors, WARNING) << "Could not find a capture element on any selected ALSA mixer.";
+		return false;
+	}
+	for (auto& m : mixers) {
+		for (auto& c : m.controls) {
+			LOG(INFO) << "Using ALSA mixer \"" << m.device << "\", element \"" << snd_mixer_selem_get_name(c.element) << "\".";
+			if (!snd_mixer_selem_has_capture_switch(c.element)) {
+				LOG(WARNING) << "ALSA mixer element \"" << snd_mixer_selem_get_name(c.element) << "\" has no capture switch, muting is not supported.";
+			}
+			snd_mixer_elem_set_callback_private(c.element, this);
+			snd_mixer_elem_set_callback(c.element, &AudioManagerAlsa::elementCallback);
+		}
+	}
+	updateCachedState(isMutedLocked(), getMasterVolumeLocked());
+	lock.unlock();
+	setupPollNotifiers();
+	return true;
+}
+
+// Requires mixerMutex to be held, adds the mixer only when at least one of the elements has been found.
+// An empty element list selects all capture elements.
+void AudioManagerAlsa::openMixer(const std::string& device, const std::vector<std::string>& elementNames, bool logErrors) {
+	Mixer mixer = { device, nullptr };
+	int err;
+	if ((err = snd_mixer_open(&mixer.handle, 0)) < 0) {
+		LOG(ERROR) << "Could not open ALSA mixer: " << snd_strerror(err);
+		return;
+	}
+	if ((err = snd_mixer_attach(mixer.handle, device.c_str())) < 0
+			|| (err = snd_mixer_selem_register(mixer.handle, nullptr, nullptr)) < 0
+			|| (err = snd_mixer_load(mixer.handle)) < 0) {
+		LOG_IF(logErrors, WARNING) << "Could not load ALSA mixer \"" << device << "\": " << snd_strerror(err);
+		snd_mixer_close(mixer.handle);
+		return;
+	}
+	for (auto elem = snd_mixer_first_elem(mixer.handle); elem; elem = snd_mixer_elem_next(elem)) {
+		if (!isCaptureElement(elem) || (!elementNames.empty()
+				&& std::find(elementNames.begin(), elementNames.end(), snd_mixer_selem_get_name(elem)) == elementNames.end())) {
+			continue;
+		}
+		Control control = { elem, 0, 0 };
+		if (!snd_mixer_selem_has_capture_volume(elem)
+				|| snd_mixer_selem_get_capture_volume_range(elem, &control.volumeMin, &control.volumeMax) < 0 || control.volumeMax <= control.volumeMin) {
+			control.volumeMin = control.volumeMax = 0;
+		}
+		mixer.controls.push_back(control);
+	}
+	if (mixer.controls.size() < elementNames.size()) {
+		LOG_IF(logErrors, WARNING) << "Could not find all selected elements on ALSA mixer \"" << device << "\".";
+	}
+	if (mixer.controls.empty()) {
+		snd_mixer_close(mixer.handle);
+	} else {
+		mixers.push_back(mixer);
+	}
+}
+
+void AudioManagerAlsa::closeMixers() {
+	std::lock_guard<std::mutex> lock(mixerMutex);
+	for (auto& m : mixers) {
+		snd_mixer_close(m.handle);
+	}
+	mixers.clear();
+}
+
+// Runs on a timer so that the poll notifiers are never deleted from within their own event.
+void AudioManagerAlsa::reopenMixers() {
+	pollNotifiers.clear();
+	closeMixers();
+	if (openMixers(false)) {
+		deviceChanged = true;
+		notifyDeviceChanged();
+	} else {
+		reopenTimer->start(reopenInterval);
+	}
+}
+
+bool AudioManagerAlsa::isValid() {
+	std::lock_guard<std::mutex> lock(mixerMutex);
+	return getPrimaryControl() != nullptr;
+}
+
+bool AudioManagerAlsa::isMuted() {
+	std::lock_guard<std::mutex> lock(mixerMutex);
+	return isMutedLocked();
+}
+
+// The elements are few and the calls are plain ioctls, so they are simply applied one after another.
+bool AudioManagerAlsa::setMuted(const bool & mute) {
+	std::lock_guard<std::mutex> lock(mixerMutex);
+	bool applied = false;
+	bool success = true;
+	for (auto& m : mixers) {
+		for (auto& c : m.controls) {
+			if (c.element && snd_mixer_selem_has_capture_switch(c.element)) {
+				applied = true;
+				success = snd_mixer_selem_set_capture_switch_all(c.element, mute ? 0 : 1) >= 0 && success;
+			}
+		}
+	}
+	if (applied && success) {
+		updateCachedMuted(mute);
+		return true;
+	}
+	return false;
+}
+
+float AudioManagerAlsa::getMasterVolume() {
+	std::lock_guard<std::mutex> lock(mixerMutex);
+	return getMasterVolumeLocked();
+}
+
+bool AudioManagerAlsa::setMasterVolume(float value) {
+	std::lock_guard<std::mutex> lock(mixerMutex);
+	bool applied = false;
+	bool success = true;
+	for (auto& m : mixers) {
+		for (auto& c : m.controls) {
+			if (c.element && c.volumeMax > c.volumeMin) {
+				applied = true;
+				long volume = c.volumeMin + std::lround(value * (c.volumeMax - c.volumeMin));
+				success = snd_mixer_selem_set_capture_volume_all(c.element, volume) >= 0 && success;
+			}
+		}
+	}
+	if (applied && success) {
+		updateCachedMasterVolume(value);
+		return true;
+	}
+	return false;
+}
+
+void AudioManagerAlsa::setupPollNotifiers() {
+	std::vector<struct pollfd> fds;
+	{
+		std::lock_guard<std::mutex> lock(mixerMutex);
+		for (auto& m : mixers) {
+			int count = snd_mixer_poll_descriptors_count(m.handle);
+			if (count <= 0) {
+				LOG(WARNING) << "ALSA mixer \"" << m.device << "\" has no poll descriptors, external changes will not be noticed.";
+				continue;
+			}
+			size_t offset = fds.size();
+			fds.resize(offset + count);
+			count = snd_mixer_poll_descriptors(m.handle, &fds[offset], count);
+			fds.resize(offset + std::max(count, 0));
+		}
+	}
+	for (auto& fd : fds) {
+		if (fd.events & POLLIN) {
+			pollNotifiers.emplace_back(new MixerPollNotifier(fd.fd, [this]() {
+				handleMixerEvents();
+			}));
+		}
+	}
+}
+
+void AudioManagerAlsa::handleMixerEvents() {
+	std::lock_guard<std::mutex> lock(mixerMutex);
+	for (auto& m : mixers) {
+		// dispatches to elementCallback()
+		int err = snd_mixer_handle_events(m.handle);
+		if (err < 0) {
+			LOG(ERROR) << "Could not handle ALSA mixer events: " << snd_strerror(err);
+			mixerLost = true;
+		}
+	}
+	if (mixerLost && !reopenTimer->isActive()) {
+		// a card is probably gone, stop listening and try to get it back
+		LOG(WARNING) << "Lost ALSA mixer element, trying to reopen the mixers.";
+		for (auto& notifier : pollNotifiers) {
+			notifier->setEnabled(false);
+		}
+		reopenTimer->start(0);
+	}
+}
+
+const AudioManagerAlsa::Control* AudioManagerAlsa::getPrimaryControl() {
+	if (mixers.empty() || !mixers[0].controls[0].element) {
+		return nullptr;
+	}
+	return &mixers[0].controls[0];
+}
+
+bool AudioManagerAlsa::isMutedLocked() {
+	int value;
+	auto control = getPrimaryControl();
+	if (control && snd_mixer_selem_has_capture_switch(control->element)
+			&& snd_mixer_selem_get_capture_switch(control->element, SND_MIXER_SCHN_FRONT_LEFT, &value) >= 0) {
+		return value == 0;
+	} else {
+		return false;
+	}
+}
+
+float AudioManagerAlsa::getMasterVolumeLocked() {
+	long value;
+	auto control = getPrimaryControl();
+	if (control && control->volumeMax > control->volumeMin
+			&& snd_mixer_selem_get_capture_volume(control->element, SND_MIXER_SCHN_FRONT_LEFT, &value) >= 0) {
+		return (float)(value - control->volumeMin) / (float)(control->volumeMax - control->volumeMin);
+	} else {
+		return 0.0;
+	}
+}
+
+bool AudioManagerAlsa::isCaptureElement(snd_mixer_elem_t* elem) {
+	return snd_mixer_selem_is_active(elem)
+		&& (snd_mixer_selem_has_capture_switch(elem) || snd_mixer_selem_has_capture_volume(elem));
+}
+
+// Called from snd_mixer_handle_events(), so mixerMutex is held.
+int AudioManagerAlsa::elementCallback(snd_mixer_elem_t* elem, unsigned int mask) {
+	auto manager = (AudioManagerAlsa*)snd_mixer_elem_get_callback_private(elem);
+	if (mask == SND_CTL_EVENT_MASK_REMOVE) {
+		LOG(WARNING) << "ALSA mixer element \"" << snd_mixer_selem_get_name(elem) << "\" has been removed.";
+		for (auto& m : manager->mixers) {
+			for (auto& c : m.controls) {
+				if (c.element == elem) {
+					c.element = nullptr;
+				}
+			}
+		}
+		manager->mixerLost = true;
+	} else if ((mask & SND_CTL_EVENT_MASK_VALUE) && elem == manager->mixers[0].controls[0].element) {
+		manager->updateCachedState(manager->isMutedLocked(), manager->getMasterVolumeLocked());
+	}
+	return 0;
+}
+
+}
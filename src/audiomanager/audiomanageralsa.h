@@ -0,0 +1,82 @@
+#pragma once
+
+#include "../audiomanager.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <QSocketNotifier>
+#include <QTimer>
+#include <alsa/asoundlib.h>
+
+
+// application namespace
+namespace miccontrol {
+
+// Controls the capture switch and capture volume of ALSA simple mixer elements.
+// Device IDs are element names on the configured mixer device or "<mixer device>/<element>", "all" selects every
+// capture element of every card.
+// Change notifications are picked up from the mixers' poll descriptors by the Qt event loop of the thread calling init().
+// When an element or a whole card goes away (e.g. an unplugged USB microphone) the mixers are reopened periodically
+// from the same event loop, once they are back the audio command worker re-applies the mute/volume state.
+class AudioManagerAlsa : public AudioManager {
+private:
+	struct Control {
+		snd_mixer_elem_t* element;
+		long volumeMin;
+		long volumeMax;
+	};
+
+	struct Mixer {
+		std::string device;
+		snd_mixer_t* handle;
+		std::vector<Control> controls;
+	};
+
+	std::string mixerDevice;
+	std::string elementName;
+
+	std::mutex mixerMutex; // guards all mixer access, the setters are called from the audio command worker
+	std::vector<Mixer> mixers; // the first control of the first mixer is the primary one
+	bool mixerLost = false;
+	std::vector<std::unique_ptr<QSocketNotifier>> pollNotifiers;
+	std::unique_ptr<QTimer> reopenTimer;
+	std::atomic<bool> deviceChanged;
+
+public:
+	AudioManagerAlsa(const std::string& mixerDevice = "default", const std::string& elementName = "Capture")
+		: mixerDevice(mixerDevice), elementName(elementName), deviceChanged(false) {}
+	~AudioManagerAlsa();
+
+	void init(OverlayController* controller) override;
+	bool isValid() override;
+
+	bool isMuted() override;
+	bool setMuted(const bool& mute) override;
+
+	float getMasterVolume() override;
+	bool setMasterVolume(float value) override;
+
+	bool rebindDevice() override;
+
+private:
+	static constexpr int reopenInterval = 1000; // ms
+
+	bool openMixers(bool logErrors = true);
+	void openMixer(const std::string& device, const std::vector<std::string>& elementNames, bool logErrors);
+	void closeMixers();
+	void reopenMixers();
+	void setupPollNotifiers();
+	void handleMixerEvents();
+
+	// the following require mixerMutex to be held
+	const Control* getPrimaryControl();
+	bool isMutedLocked();
+	float getMasterVolumeLocked();
+
+	static bool isCaptureElement(snd_mixer_elem_t* elem);
+	static int elementCallback(snd_mixer_elem_t* elem, unsigned int mask);
+};
+
+}
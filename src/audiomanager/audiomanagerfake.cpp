@@ -0,0 +1,352 @@
+#include "audiomanagerfake.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include "../logging.h"
+
+
+// application namespace
+namespace miccontrol {
+
+FakeAudioConfig FakeAudioConfig::parse(const std::string& value) {
+	FakeAudioConfig config;
+	std::istringstream in(value);
+	std::string item;
+	while (std::getline(in, item, ',')) {
+		size_t pos = item.find('=');
+		if (pos == std::string::npos) {
+			LOG(WARNING) << "Ignoring fake audio option \"" << item << "\".";
+			continue;
+		}
+		std::string key = item.substr(0, pos);
+		std::string arg = item.substr(pos + 1);
+		try {
+			if (key == "distribution") {
+				if (arg == "constant") {
+					config.distribution = DISTRIBUTION_CONSTANT;
+				} else if (arg == "uniform") {
+					config.distribution = DISTRIBUTION_UNIFORM;
+				} else if (arg == "normal") {
+					config.distribution = DISTRIBUTION_NORMAL;
+				} else if (arg == "exponential") {
+					config.distribution = DISTRIBUTION_EXPONENTIAL;
+				} else {
+					LOG(WARNING) << "Unknown fake audio latency distribution \"" << arg << "\".";
+				}
+			} else if (key == "latency") {
+				config.latency = std::max(std::stod(arg), 0.0);
+			} else if (key == "jitter") {
+				config.jitter = std::max(std::stod(arg), 0.0);
+			} else if (key == "failure") {
+				config.failureRate = std::min(std::max(std::stod(arg), 0.0), 1.0);
+			} else if (key == "seed") {
+				config.seed = (uint32_t)std::stoul(arg);
+			} else if (key == "calls") {
+				config.callLimit = std::max<size_t>(std::stoul(arg), 1);
+			} else if (key == "log") {
+				config.callLogFile = arg;
+			} else if (key == "devicechange") {
+				config.deviceChangeInterval = (unsigned)std::stoul(arg);
+			} else if (key == "externalmute") {
+				config.externalMuteInterval = (unsigned)std::stoul(arg);
+			} else {
+				LOG(WARNING) << "Ignoring fake audio option \"" << item << "\".";
+			}
+		} catch (const std::exception&) {
+			LOG(WARNING) << "Invalid value for fake audio option \"" << item << "\".";
+		}
+	}
+	return config;
+}
+
+
+static unsigned writeCalls(std::ostream& out, const std::vector<AudioManagerFake::Call>& calls, AudioManagerFake::Clock::time_point createTime) {
+	unsigned failures = 0;
+	for (auto& c : calls) {
+		out << c.type << "," << c.value << "," << c.success << ","
+			<< std::chrono::duration_cast<std::chrono::microseconds>(c.start - createTime).count() << ","
+			<< std::chrono::duration_cast<std::chrono::microseconds>(c.end - createTime).count() << "\n";
+		if (!c.success) {
+			failures++;
+		}
+	}
+	return failures;
+}
+
+
+AudioManagerFake::AudioManagerFake(const FakeAudioConfig& config) : config(config), random(config.seed), createTime(Clock::now()) {
+	calls.reserve(std::min<size_t>(config.callLimit, 4096));
+}
+
+void AudioManagerFake::init(OverlayController* controller) {
+	this->controller = controller;
+	LOG(INFO) << "Using fake audio device (latency " << config.latency << " ms, jitter " << config.jitter << " ms, distribution "
+		<< config.distribution << ", failure rate " << config.failureRate << ", seed " << config.seed << ").";
+	updateCachedState(muted, masterVolume);
+	if (config.deviceChangeInterval) {
+		scheduleDeviceChange();
+	}
+	if (config.externalMuteInterval) {
+		scheduleExternalMute();
+	}
+}
+
+bool AudioManagerFake::isValid() {
+	return true;
+}
+
+bool AudioManagerFake::isMuted() {
+	auto start = Clock::now();
+	bool success = simulateCall();
+	std::lock_guard<std::mutex> lock(mutex);
+	bool value = success && muted;
+	recordCall(CALL_IS_MUTED, value, success, start);
+	return value;
+}
+
+bool AudioManagerFake::setMuted(const bool & mute) {
+	auto start = Clock::now();
+	bool success = simulateCall();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (success) {
+			muted = mute;
+		}
+		recordCall(CALL_SET_MUTED, mute, success, start);
+	}
+	if (success) {
+		updateCachedMuted(mute);
+	}
+	return success;
+}
+
+float AudioManagerFake::getMasterVolume() {
+	auto start = Clock::now();
+	bool success = simulateCall();
+	std::lock_guard<std::mutex> lock(mutex);
+	float value = success ? masterVolume : 0.0f;
+	recordCall(CALL_GET_MASTER_VOLUME, value, success, start);
+	return value;
+}
+
+bool AudioManagerFake::setMasterVolume(float value) {
+	auto start = Clock::now();
+	bool success = simulateCall();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (success) {
+			masterVolume = value;
+		}
+		recordCall(CALL_SET_MASTER_VOLUME, value, success, start);
+	}
+	if (success) {
+		updateCachedMasterVolume(value);
+	}
+	return success;
+}
+
+bool AudioManagerFake::rebindDevice() {
+	auto start = Clock::now();
+	std::lock_guard<std::mutex> lock(mutex);
+	bool changed = deviceChangePending;
+	deviceChangePending = false;
+	recordCall(CALL_REBIND_DEVICE, changed, true, start);
+	return changed;
+}
+
+void AudioManagerFake::simulateExternalChange(bool muted, float masterVolume) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		this->muted = muted;
+		this->masterVolume = masterVolume;
+	}
+	updateCachedState(muted, masterVolume);
+}
+
+void AudioManagerFake::simulateDeviceChange() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		deviceChangePending = true;
+	}
+	notifyDeviceChanged();
+}
+
+void AudioManagerFake::scheduleDeviceChange() {
+	scheduler.schedule(std::chrono::milliseconds(config.deviceChangeInterval), [this]() {
+		simulateDeviceChange();
+		scheduleDeviceChange();
+	});
+}
+
+void AudioManagerFake::scheduleExternalMute() {
+	scheduler.schedule(std::chrono::milliseconds(config.externalMuteInterval), [this]() {
+		bool value;
+		float volume;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			value = !muted;
+			volume = masterVolume;
+		}
+		simulateExternalChange(value, volume);
+		scheduleExternalMute();
+	});
+}
+
+std::vector<AudioManagerFake::Call> AudioManagerFake::getCalls() {
+	std::lock_guard<std::mutex> lock(mutex);
+	return snapshotCalls();
+}
+
+void AudioManagerFake::clearCalls() {
+	std::lock_guard<std::mutex> lock(mutex);
+	calls.clear();
+	nextCall = 0;
+}
+
+uint64_t AudioManagerFake::getDroppedCallCount() {
+	std::lock_guard<std::mutex> lock(mutex);
+	return droppedCalls;
+}
+
+bool AudioManagerFake::writeCallLog(const std::string& path) {
+	std::vector<Call> snapshot;
+	uint64_t dropped;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		snapshot = snapshotCalls();
+		dropped = droppedCalls;
+	}
+	std::ofstream out(path);
+	if (!out) {
+		LOG(ERROR) << "Could not write fake audio call log to " << path << ".";
+		return false;
+	}
+	out << "type,value,success,start_us,end_us\n";
+	unsigned failures = writeCalls(out, snapshot, createTime);
+	LOG(INFO) << "Wrote " << snapshot.size() << " fake audio calls (" << failures << " failed, " << dropped << " older ones dropped) to " << path << ".";
+	return true;
+}
+
+bool AudioManagerFake::writeCallLog() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (config.callLogFile.empty()) {
+			return true;
+		}
+	}
+	if (!flushCallLog(true)) {
+		return false;
+	}
+	std::lock_guard<std::mutex> logLock(callLogMutex);
+	LOG(INFO) << "Wrote " << loggedCalls << " fake audio calls (" << loggedFailures << " failed) to " << config.callLogFile << ".";
+	return true;
+}
+
+// Requires mutex to be held.
+std::vector<AudioManagerFake::Call> AudioManagerFake::snapshotCalls() {
+	std::vector<Call> snapshot(calls.begin() + nextCall, calls.end());
+	snapshot.insert(snapshot.end(), calls.begin(), calls.begin() + nextCall);
+	return snapshot;
+}
+
+// The first write truncates the file, so a log always covers a single run.
+bool AudioManagerFake::flushCallLog(bool remaining) {
+	std::lock_guard<std::mutex> logLock(callLogMutex);
+	std::vector<std::vector<Call>> batches;
+	std::string path;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		batches.swap(unloggedCalls);
+		callLogFlushScheduled = false;
+		if (remaining) {
+			batches.push_back(snapshotCalls());
+			calls.clear();
+			nextCall = 0;
+		}
+		path = config.callLogFile;
+	}
+	if (path.empty()) {
+		return false;
+	}
+
+	std::ofstream out(path, callLogStarted ? std::ios::app : std::ios::trunc);
+	if (!out) {
+		LOG(ERROR) << "Could not write fake audio call log to " << path << ", keeping only the last " << config.callLimit << " calls.";
+		std::lock_guard<std::mutex> lock(mutex);
+		config.callLogFile.clear();
+		// back into the ring buffer, as if there never had been a log file
+		std::vector<Call> kept;
+		for (auto& batch : batches) {
+			kept.insert(kept.end(), batch.begin(), batch.end());
+		}
+		auto current = snapshotCalls();
+		kept.insert(kept.end(), current.begin(), current.end());
+		size_t excess = kept.size() > config.callLimit ? kept.size() - config.callLimit : 0;
+		droppedCalls += excess;
+		calls.assign(kept.begin() + excess, kept.end());
+		nextCall = 0;
+		return false;
+	}
+	if (!callLogStarted) {
+		out << "type,value,success,start_us,end_us\n";
+		callLogStarted = true;
+	}
+	for (auto& batch : batches) {
+		loggedFailures += writeCalls(out, batch, createTime);
+		loggedCalls += batch.size();
+	}
+	return true;
+}
+
+bool AudioManagerFake::simulateCall() {
+	double latency;
+	bool success;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		switch (config.distribution) {
+			case FakeAudioConfig::DISTRIBUTION_UNIFORM:
+				latency = std::uniform_real_distribution<double>(config.latency - config.jitter, config.latency + config.jitter)(random);
+				break;
+			case FakeAudioConfig::DISTRIBUTION_NORMAL:
+				latency = config.jitter > 0.0 ? std::normal_distribution<double>(config.latency, config.jitter)(random) : config.latency;
+				break;
+			case FakeAudioConfig::DISTRIBUTION_EXPONENTIAL:
+				latency = config.latency + (config.jitter > 0.0 ? std::exponential_distribution<double>(1.0 / config.jitter)(random) : 0.0);
+				break;
+			default:
+				latency = config.latency;
+				break;
+		}
+		success = config.failureRate <= 0.0 || std::uniform_real_distribution<double>(0.0, 1.0)(random) >= config.failureRate;
+	}
+	if (latency > 0.0) {
+		std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(latency));
+	}
+	return success;
+}
+
+// Requires mutex to be held.
+void AudioManagerFake::recordCall(CallType type, float value, bool success, Clock::time_point start) {
+	Call call = { type, value, success, start, Clock::now() };
+	if (calls.size() >= config.callLimit && config.callLogFile.empty()) {
+		calls[nextCall] = call;
+		nextCall = (nextCall + 1) % calls.size();
+		droppedCalls++;
+		return;
+	} else if (calls.size() >= config.callLimit) {
+		// no file I/O here, this runs with the lock held on every call
+		unloggedCalls.push_back(std::move(calls));
+		calls = std::vector<Call>();
+		calls.reserve(std::min<size_t>(config.callLimit, 4096));
+		if (!callLogFlushScheduled) {
+			callLogFlushScheduled = true;
+			scheduler.schedule(std::chrono::milliseconds(0), [this]() {
+				flushCallLog(false);
+			});
+		}
+	}
+	calls.push_back(call);
+}
+
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "../audiomanager.h"
+#include "../deadlinescheduler.h"
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+
+// application namespace
+namespace miccontrol {
+
+struct FakeAudioConfig {
+	enum Distribution {
+		DISTRIBUTION_CONSTANT = 0, // always latency
+		DISTRIBUTION_UNIFORM = 1, // latency +/- jitter
+		DISTRIBUTION_NORMAL = 2, // mean latency, standard deviation jitter
+		DISTRIBUTION_EXPONENTIAL = 3, // latency + exponentially distributed tail with mean jitter
+	};
+
+	Distribution distribution = DISTRIBUTION_CONSTANT;
+	double latency = 0.0; // ms
+	double jitter = 0.0; // ms
+	double failureRate = 0.0; // 0.0 .. 1.0
+	uint32_t seed = 0;
+	size_t callLimit = 65536; // recorded calls kept in memory
+	std::string callLogFile; // when set, the recorded calls are appended whenever callLimit is reached and by writeCallLog()
+	unsigned deviceChangeInterval = 0; // ms, simulateDeviceChange() periodically when > 0
+	unsigned externalMuteInterval = 0; // ms, toggle the mute state with simulateExternalChange() periodically when > 0
+
+	// comma-separated key=value pairs, e.g. "distribution=normal,latency=2,jitter=0.5,failure=0.01,seed=42,log=calls.csv"
+	static FakeAudioConfig parse(const std::string& value);
+};
+
+
+// Audio manager without any audio stack behind it, for benchmarks and regression tests on headless machines.
+// Every call takes a configurable (randomized but seeded, hence reproducible) time, fails with a configurable
+// probability and is recorded with its timestamps. Only the last callLimit calls are kept, unless a call log file
+// is set: then every full buffer is handed to the scheduler thread, which appends it to the file outside of the lock.
+class AudioManagerFake : public AudioManager {
+public:
+	typedef std::chrono::steady_clock Clock;
+
+	enum CallType {
+		CALL_IS_MUTED = 0,
+		CALL_SET_MUTED = 1,
+		CALL_GET_MASTER_VOLUME = 2,
+		CALL_SET_MASTER_VOLUME = 3,
+		CALL_REBIND_DEVICE = 4,
+	};
+
+	struct Call {
+		CallType type;
+		float value; // the muted state or the volume that has been set or returned
+		bool success;
+		Clock::time_point start;
+		Clock::time_point end;
+	};
+
+private:
+	FakeAudioConfig config;
+	std::mutex mutex;
+	std::mt19937 random;
+	bool muted = false;
+	float masterVolume = 1.0f;
+	bool deviceChangePending = false;
+	Clock::time_point createTime;
+	std::vector<Call> calls; // ring buffer of config.callLimit calls
+	size_t nextCall = 0; // oldest call once the ring buffer is full
+	uint64_t droppedCalls = 0;
+	std::vector<std::vector<Call>> unloggedCalls; // full buffers waiting for flushCallLog()
+	bool callLogFlushScheduled = false;
+	std::mutex callLogMutex; // serializes the writes, taken before mutex
+	bool callLogStarted = false; // guarded by callLogMutex, like the counters
+	uint64_t loggedCalls = 0;
+	uint64_t loggedFailures = 0;
+	DeadlineScheduler scheduler; // keep last, its callbacks use the members above
+
+public:
+	AudioManagerFake(const FakeAudioConfig& config = FakeAudioConfig());
+
+	void init(OverlayController* controller) override;
+	bool isValid() override;
+
+	bool isMuted() override;
+	bool setMuted(const bool& mute) override;
+
+	float getMasterVolume() override;
+	bool setMasterVolume(float value) override;
+
+	bool rebindDevice() override;
+
+	// pretend that something outside of this application changed the device state
+	void simulateExternalChange(bool muted, float masterVolume);
+	// pretend that the default device changed, the next rebind reports a new device
+	void simulateDeviceChange();
+
+	// the recorded calls in chronological order, without the ones already handed to the call log
+	std::vector<Call> getCalls();
+	void clearCalls();
+	// calls that were overwritten in the ring buffer before anyone read them
+	uint64_t getDroppedCallCount();
+	// CSV with one line per call, times in microseconds since construction
+	bool writeCallLog(const std::string& path);
+	// appends the remaining calls to the configured call log
+	bool writeCallLog();
+
+private:
+	void scheduleDeviceChange();
+	void scheduleExternalMute();
+	// Requires mutex to be held.
+	std::vector<Call> snapshotCalls();
+	// appends the full buffers (and with remaining also the current one) to the call log, requires no lock to be held
+	bool flushCallLog(bool remaining);
+	// simulates the call latency, returns whether the call succeeds
+	bool simulateCall();
+	void recordCall(CallType type, float value, bool success, Clock::time_point start);
+};
+
+}
@@ -0,0 +1,426 @@
+#include "audiomanagerpulse.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "../logging.h"
+
+
+// application namespace
+namespace miccontrol {
+
+namespace {
+
+struct OperationResult {
+	pa_threaded_mainloop* mainloop;
+	bool success;
+};
+
+void successCallback(pa_context* c, int success, void* userdata) {
+	auto result = (OperationResult*)userdata;
+	result->success = success != 0;
+	pa_threaded_mainloop_signal(result->mainloop, 0);
+}
+
+float toMasterVolume(pa_volume_t volume) {
+	return std::min((float)volume / (float)PA_VOLUME_NORM, 1.0f);
+}
+
+} // anonymous namespace
+
+
+AudioManagerPulse::~AudioManagerPulse() {
+	if (mainloop) {
+		pa_threaded_mainloop_stop(mainloop);
+	}
+	disconnectContext();
+	if (reconnectEvent) {
+		auto api = pa_threaded_mainloop_get_api(mainloop);
+		api->time_free(reconnectEvent);
+	}
+	if (mainloop) {
+		pa_threaded_mainloop_free(mainloop);
+	}
+}
+
+void AudioManagerPulse::init(OverlayController* controller) {
+	this->controller = controller;
+	mainloop = pa_threaded_mainloop_new();
+	if (!mainloop) {
+		throw std::runtime_error("Could not create PulseAudio mainloop");
+	}
+	if (pa_threaded_mainloop_start(mainloop) < 0) {
+		throw std::runtime_error("Could not start PulseAudio mainloop");
+	}
+
+	pa_threaded_mainloop_lock(mainloop);
+	if (!connectContext()) {
+		LOG(WARNING) << "Could not connect to PulseAudio.";
+		scheduleReconnect();
+		pa_threaded_mainloop_unlock(mainloop);
+		return;
+	}
+	pa_context_state_t state;
+	while ((state = pa_context_get_state(context)) != PA_CONTEXT_READY && PA_CONTEXT_IS_GOOD(state)) {
+		pa_threaded_mainloop_wait(mainloop);
+	}
+	if (state == PA_CONTEXT_READY) {
+		ready = true;
+		pa_operation* op = pa_context_subscribe(context, (pa_subscription_mask_t)(PA_SUBSCRIPTION_MASK_SOURCE | PA_SUBSCRIPTION_MASK_SERVER), nullptr, nullptr);
+		if (op) {
+			pa_operation_unref(op);
+		}
+		sources = resolveSources();
+		logSources();
+		if (!sources.empty()) {
+			updateCachedState(sources[0].muted, toMasterVolume(sources[0].volume));
+		}
+	} else {
+		// contextStateCallback() already scheduled the reconnect
+		LOG(WARNING) << "Could not connect to PulseAudio: " << pa_strerror(pa_context_errno(context));
+	}
+	pa_threaded_mainloop_unlock(mainloop);
+}
+
+bool AudioManagerPulse::isValid() {
+	if (!ready) {
+		return false;
+	}
+	pa_threaded_mainloop_lock(mainloop);
+	bool retval = !sources.empty();
+	pa_threaded_mainloop_unlock(mainloop);
+	return retval;
+}
+
+bool AudioManagerPulse::isMuted() {
+	if (!ready) {
+		return false;
+	}
+	pa_threaded_mainloop_lock(mainloop);
+	bool retval = refreshPrimarySource() && sources[0].muted;
+	pa_threaded_mainloop_unlock(mainloop);
+	return retval;
+}
+
+bool AudioManagerPulse::setMuted(const bool & mute) {
+	if (!ready) {
+		return false;
+	}
+	pa_threaded_mainloop_lock(mainloop);
+	bool retval = applyToSources([this, mute](const Source& source, pa_context_success_cb_t cb, void* userdata) {
+		return pa_context_set_source_mute_by_index(context, source.index, mute, cb, userdata);
+	});
+	if (retval) {
+		updateCachedMuted(mute);
+	}
+	pa_threaded_mainloop_unlock(mainloop);
+	return retval;
+}
+
+float AudioManagerPulse::getMasterVolume() {
+	if (!ready) {
+		return 0.0;
+	}
+	pa_threaded_mainloop_lock(mainloop);
+	float retval = refreshPrimarySource() ? toMasterVolume(sources[0].volume) : 0.0f;
+	pa_threaded_mainloop_unlock(mainloop);
+	return retval;
+}
+
+bool AudioManagerPulse::setMasterVolume(float value) {
+	if (!ready) {
+		return false;
+	}
+	pa_threaded_mainloop_lock(mainloop);
+	pa_volume_t volume = (pa_volume_t)std::lround(value * PA_VOLUME_NORM);
+	bool retval = applyToSources([this, volume](const Source& source, pa_context_success_cb_t cb, void* userdata) {
+		// keeps the balance between the channels, the loudest one gets the new volume
+		pa_cvolume cvolume = source.cvolume;
+		pa_cvolume_scale(&cvolume, volume);
+		return pa_context_set_source_volume_by_index(context, source.index, &cvolume, cb, userdata);
+	});
+	if (retval) {
+		updateCachedMasterVolume(value);
+	}
+	pa_threaded_mainloop_unlock(mainloop);
+	return retval;
+}
+
+bool AudioManagerPulse::rebindDevice() {
+	if (!ready) {
+		return false;
+	}
+	pa_threaded_mainloop_lock(mainloop);
+	auto newSources = resolveSources();
+	bool changed = newSources.size() != sources.size();
+	for (size_t i = 0; i < newSources.size() && !changed; i++) {
+		changed = newSources[i].index != sources[i].index;
+	}
+	sources = newSources;
+	if (changed) {
+		logSources();
+	}
+	if (!sources.empty()) {
+		updateCachedState(sources[0].muted, toMasterVolume(sources[0].volume));
+	}
+	pa_threaded_mainloop_unlock(mainloop);
+	return changed && !sources.empty();
+}
+
+bool AudioManagerPulse::connectContext() {
+	context = pa_context_new(pa_threaded_mainloop_get_api(mainloop), "MicrophoneControl");
+	if (!context) {
+		return false;
+	}
+	pa_context_set_state_callback(context, &AudioManagerPulse::contextStateCallback, this);
+	pa_context_set_subscribe_callback(context, &AudioManagerPulse::subscriptionCallback, this);
+	if (pa_context_connect(context, nullptr, PA_CONTEXT_NOFLAGS, nullptr) < 0) {
+		LOG(WARNING) << "Could not connect to PulseAudio: " << pa_strerror(pa_context_errno(context));
+		disconnectContext();
+		return false;
+	}
+	return true;
+}
+
+void AudioManagerPulse::disconnectContext() {
+	if (context) {
+		// no callbacks for the old context anymore, it would schedule another reconnect when it terminates
+		pa_context_set_state_callback(context, nullptr, nullptr);
+		pa_context_set_subscribe_callback(context, nullptr, nullptr);
+		pa_context_disconnect(context);
+		pa_context_unref(context);
+		context = nullptr;
+	}
+}
+
+// Doubles the delay with every attempt until a connection has been made.
+void AudioManagerPulse::scheduleReconnect() {
+	if (reconnectEvent) {
+		return;
+	}
+	LOG(INFO) << "Reconnecting to PulseAudio in " << reconnectInterval << " ms.";
+	struct timeval tv;
+	pa_timeval_add(pa_gettimeofday(&tv), (pa_usec_t)reconnectInterval * PA_USEC_PER_MSEC);
+	auto api = pa_threaded_mainloop_get_api(mainloop);
+	reconnectEvent = api->time_new(api, &tv, &AudioManagerPulse::reconnectCallback, this);
+	reconnectInterval *= 2;
+	if (reconnectInterval > maxReconnectInterval) {
+		reconnectInterval = maxReconnectInterval;
+	}
+}
+
+// Runs on the mainloop thread and must not wait for the server, the sources are resolved by rebindDevice() once
+// contextStateCallback() has seen the new context become ready.
+void AudioManagerPulse::reconnect() {
+	disconnectContext();
+	sources.clear();
+	reconnecting = true;
+	if (!connectContext()) {
+		scheduleReconnect();
+	}
+}
+
+bool AudioManagerPulse::waitForOperation(pa_operation* op) {
+	if (!op) {
+		return false;
+	}
+	pa_operation_state_t state;
+	while ((state = pa_operation_get_state(op)) == PA_OPERATION_RUNNING) {
+		pa_threaded_mainloop_wait(mainloop);
+	}
+	pa_operation_unref(op);
+	return state == PA_OPERATION_DONE;
+}
+
+// The default source (if selected) always comes first.
+std::vector<AudioManagerPulse::Source> AudioManagerPulse::resolveSources() {
+	SourceQuery query = { mainloop, deviceSelection.mode == AudioDeviceSelection::MODE_ALL };
+	if (deviceSelection.mode == AudioDeviceSelection::MODE_ALL) {
+		waitForOperation(pa_context_get_server_info(context, &AudioManagerPulse::serverInfoCallback, &query));
+		waitForOperation(pa_context_get_source_info_list(context, &AudioManagerPulse::sourceQueryCallback, &query));
+		std::stable_partition(query.sources.begin(), query.sources.end(), [&query](const Source& source) {
+			return source.name == query.defaultSourceName;
+		});
+	} else {
+		std::vector<std::string> names;
+		if (deviceSelection.mode == AudioDeviceSelection::MODE_LIST) {
+			names = deviceSelection.ids;
+		} else {
+			names.push_back("@DEFAULT_SOURCE@");
+		}
+		for (auto& name : names) {
+			size_t count = query.sources.size();
+			waitForOperation(pa_context_get_source_info_by_name(context, name.c_str(), &AudioManagerPulse::sourceQueryCallback, &query));
+			if (query.sources.size() == count) {
+				LOG(WARNING) << "Could not find PulseAudio source \"" << name << "\".";
+				continue;
+			}
+			uint32_t index = query.sources.back().index;
+			if (std::count_if(query.sources.begin(), query.sources.end(), [index](const Source& source) {
+				return source.index == index;
+			}) > 1) {
+				query.sources.pop_back(); // listed twice
+			}
+		}
+	}
+	return query.sources;
+}
+
+bool AudioManagerPulse::refreshPrimarySource() {
+	if (sources.empty()) {
+		return false;
+	}
+	// sourceInfoCallback() updates the entry, it might also be gone by the time this returns
+	return waitForOperation(pa_context_get_source_info_by_index(context, sources[0].index, &AudioManagerPulse::sourceInfoCallback, this))
+		&& !sources.empty();
+}
+
+// Sends the command to all sources before waiting for any reply, so that they are processed concurrently.
+// Returns true when the command succeeded on all sources.
+bool AudioManagerPulse::applyToSources(const std::function<pa_operation*(const Source&, pa_context_success_cb_t, void*)>& call) {
+	if (sources.empty()) {
+		return false;
+	}
+	// the source list may change while waiting, so it is not touched anymore after the commands have been sent
+	std::vector<OperationResult> results(sources.size(), { mainloop, false });
+	std::vector<pa_operation*> ops;
+	for (size_t i = 0; i < sources.size(); i++) {
+		ops.push_back(call(sources[i], &successCallback, &results[i]));
+	}
+	bool success = true;
+	for (size_t i = 0; i < ops.size(); i++) {
+		success = waitForOperation(ops[i]) && results[i].success && success;
+	}
+	return success;
+}
+
+void AudioManagerPulse::applySourceInfo(const pa_source_info* info) {
+	for (size_t i = 0; i < sources.size(); i++) {
+		if (sources[i].index == info->index) {
+			sources[i] = makeSource(info);
+			if (i == 0) {
+				updateCachedState(sources[0].muted, toMasterVolume(sources[0].volume));
+			}
+			break;
+		}
+	}
+}
+
+void AudioManagerPulse::logSources() {
+	if (sources.empty()) {
+		LOG(WARNING) << "Could not find a PulseAudio source.";
+	}
+	for (auto& source : sources) {
+		LOG(INFO) << "Using PulseAudio source \"" << source.name << "\" (index " << source.index << ").";
+	}
+}
+
+AudioManagerPulse::Source AudioManagerPulse::makeSource(const pa_source_info* info) {
+	Source source;
+	source.name = info->name;
+	source.index = info->index;
+	source.channels = std::max<uint8_t>(info->volume.channels, 1);
+	source.muted = info->mute != 0;
+	source.volume = pa_cvolume_max(&info->volume);
+	source.cvolume = info->volume;
+	if (!pa_cvolume_valid(&source.cvolume)) {
+		pa_cvolume_set(&source.cvolume, source.channels, source.volume);
+	}
+	return source;
+}
+
+void AudioManagerPulse::contextStateCallback(pa_context* c, void* userdata) {
+	auto manager = (AudioManagerPulse*)userdata;
+	auto state = pa_context_get_state(c);
+	if (!PA_CONTEXT_IS_GOOD(state)) {
+		if (manager->ready.exchange(false)) {
+			LOG(ERROR) << "Lost connection to PulseAudio: " << pa_strerror(pa_context_errno(c));
+		}
+		// the sources are gone with the server, the rebind after reconnecting will find them changed
+		manager->sources.clear();
+		manager->scheduleReconnect();
+	} else if (state == PA_CONTEXT_READY && manager->reconnecting) {
+		manager->reconnecting = false;
+		manager->reconnectInterval = minReconnectInterval;
+		pa_operation* op = pa_context_subscribe(c, (pa_subscription_mask_t)(PA_SUBSCRIPTION_MASK_SOURCE | PA_SUBSCRIPTION_MASK_SERVER), nullptr, nullptr);
+		if (op) {
+			pa_operation_unref(op);
+		}
+		manager->ready = true;
+		LOG(INFO) << "Reconnected to PulseAudio.";
+		manager->notifyDeviceChanged();
+	} else if (state == PA_CONTEXT_READY) {
+		manager->reconnectInterval = minReconnectInterval;
+	}
+	pa_threaded_mainloop_signal(manager->mainloop, 0);
+}
+
+void AudioManagerPulse::reconnectCallback(pa_mainloop_api* api, pa_time_event* e, const struct timeval* tv, void* userdata) {
+	auto manager = (AudioManagerPulse*)userdata;
+	api->time_free(e);
+	manager->reconnectEvent = nullptr;
+	manager->reconnect();
+}
+
+// Runs on the mainloop thread, device changes are only signalled, the audio command worker does the rebind.
+void AudioManagerPulse::subscriptionCallback(pa_context* c, pa_subscription_event_type_t type, uint32_t index, void* userdata) {
+	auto manager = (AudioManagerPulse*)userdata;
+	auto facility = type & PA_SUBSCRIPTION_EVENT_FACILITY_MASK;
+	auto eventType = type & PA_SUBSCRIPTION_EVENT_TYPE_MASK;
+	auto mode = manager->deviceSelection.mode;
+	if (facility == PA_SUBSCRIPTION_EVENT_SERVER) {
+		// the default source might have changed
+		if (mode != AudioDeviceSelection::MODE_LIST) {
+			manager->notifyDeviceChanged();
+		}
+		return;
+	} else if (facility != PA_SUBSCRIPTION_EVENT_SOURCE) {
+		return;
+	}
+	auto source = std::find_if(manager->sources.begin(), manager->sources.end(), [index](const Source& s) {
+		return s.index == index;
+	});
+	if (eventType == PA_SUBSCRIPTION_EVENT_NEW) {
+		// a selected source might have come back
+		if (mode != AudioDeviceSelection::MODE_DEFAULT) {
+			manager->notifyDeviceChanged();
+		}
+	} else if (source == manager->sources.end()) {
+		return;
+	} else if (eventType == PA_SUBSCRIPTION_EVENT_REMOVE) {
+		LOG(WARNING) << "PulseAudio source \"" << source->name << "\" has been removed.";
+		manager->sources.erase(source);
+		manager->notifyDeviceChanged();
+	} else {
+		// the reply is handled by sourceInfoCallback() on the mainloop thread, nobody waits for it
+		pa_operation* op = pa_context_get_source_info_by_index(c, index, &AudioManagerPulse::sourceInfoCallback, manager);
+		if (op) {
+			pa_operation_unref(op);
+		}
+	}
+}
+
+void AudioManagerPulse::sourceInfoCallback(pa_context* c, const pa_source_info* info, int eol, void* userdata) {
+	auto manager = (AudioManagerPulse*)userdata;
+	if (!eol && info) {
+		manager->applySourceInfo(info);
+	}
+	pa_threaded_mainloop_signal(manager->mainloop, 0);
+}
+
+void AudioManagerPulse::sourceQueryCallback(pa_context* c, const pa_source_info* info, int eol, void* userdata) {
+	auto query = (SourceQuery*)userdata;
+	if (!eol && info && !(query->skipMonitors && info->monitor_of_sink != PA_INVALID_INDEX)) {
+		query->sources.push_back(makeSource(info));
+	}
+	pa_threaded_mainloop_signal(query->mainloop, 0);
+}
+
+void AudioManagerPulse::serverInfoCallback(pa_context* c, const pa_server_info* info, void* userdata) {
+	auto query = (SourceQuery*)userdata;
+	if (info && info->default_source_name) {
+		query->defaultSourceName = info->default_source_name;
+	}
+	pa_threaded_mainloop_signal(query->mainloop, 0);
+}
+
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "../audiomanager.h"
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+#include <pulse/pulseaudio.h>
+
+
+// application namespace
+namespace miccontrol {
+
+// Controls PulseAudio (or PipeWire's pulse server) sources through a threaded mainloop.
+// Source changes are pushed by the server through a subscription, the setters block until the server acknowledged them.
+// Device IDs are source names, changes of the server's default source or the set of sources rebind the selection.
+// When the server can't be reached or goes away (e.g. a restarted PipeWire) the context is recreated with an increasing
+// delay, the reconnect is signalled as a device change so that the audio command worker re-applies the state.
+class AudioManagerPulse : public AudioManager {
+private:
+	struct Source {
+		std::string name;
+		uint32_t index;
+		uint8_t channels;
+		bool muted;
+		pa_volume_t volume; // the loudest channel
+		pa_cvolume cvolume;
+	};
+
+	struct SourceQuery {
+		pa_threaded_mainloop* mainloop;
+		bool skipMonitors;
+		std::string defaultSourceName;
+		std::vector<Source> sources;
+	};
+
+	pa_threaded_mainloop* mainloop = nullptr;
+	pa_context* context = nullptr;
+	std::atomic<bool> ready;
+
+	// only accessed with the mainloop lock held, the first one is the primary source
+	std::vector<Source> sources;
+
+	// only accessed with the mainloop lock held
+	pa_time_event* reconnectEvent = nullptr;
+	int reconnectInterval = minReconnectInterval;
+	bool reconnecting = false;
+
+	static constexpr int minReconnectInterval = 500; // ms
+	static constexpr int maxReconnectInterval = 30000; // ms
+
+public:
+	AudioManagerPulse() : ready(false) {}
+	~AudioManagerPulse();
+
+	void init(OverlayController* controller) override;
+	bool isValid() override;
+
+	bool isMuted() override;
+	bool setMuted(const bool& mute) override;
+
+	float getMasterVolume() override;
+	bool setMasterVolume(float value) override;
+
+	bool rebindDevice() override;
+
+private:
+	// the following require the mainloop lock to be held
+	bool connectContext();
+	void disconnectContext();
+	void scheduleReconnect();
+	void reconnect();
+	bool waitForOperation(pa_operation* op);
+	std::vector<Source> resolveSources();
+	bool refreshPrimarySource();
+	bool applyToSources(const std::function<pa_operation*(const Source&, pa_context_success_cb_t, void*)>& call);
+	void applySourceInfo(const pa_source_info* info);
+	void logSources();
+
+	static Source makeSource(const pa_source_info* info);
+	static void contextStateCallback(pa_context* c, void* userdata);
+	static void reconnectCallback(pa_mainloop_api* api, pa_time_event* e, const struct timeval* tv, void* userdata);
+	static void subscriptionCallback(pa_context* c, pa_subscription_event_type_t type, uint32_t index, void* userdata);
+	static void sourceInfoCallback(pa_context* c, const pa_source_info* info, int eol, void* userdata);
+	static void sourceQueryCallback(pa_context* c, const pa_source_info* info, int eol, void* userdata);
+	static void serverInfoCallback(pa_context* c, const pa_server_info* info, void* userdata);
+};
+
+}
@@ -1,19 +1,193 @@
 #include "audiomanagerwindows.h"
+#include <algorithm>
 #include <exception>
+#include <future>
 #include "../logging.h"
 
 
 // application namespace
 namespace miccontrol {
 
+ULONG STDMETHODCALLTYPE AudioEndpointVolumeCallback::AddRef() {
+	return ++refCount;
+}
+
+
+ULONG STDMETHODCALLTYPE AudioEndpointVolumeCallback::Release() {
+	ULONG count = --refCount;
+	if (count == 0) {
+		delete this;
+	}
+	return count;
+}
+
+
+HRESULT STDMETHODCALLTYPE AudioEndpointVolumeCallback::QueryInterface(REFIID riid, VOID** ppvInterface) {
+	if (riid == IID_IUnknown) {
+		AddRef();
+		*ppvInterface = (IUnknown*)this;
+	} else if (riid == __uuidof(IAudioEndpointVolumeCallback)) {
+		AddRef();
+		*ppvInterface = (IAudioEndpointVolumeCallback*)this;
+	} else {
+		*ppvInterface = NULL;
+		return E_NOINTERFACE;
+	}
+	return S_OK;
+}
+
+
+HRESULT STDMETHODCALLTYPE AudioEndpointVolumeCallback::OnNotify(PAUDIO_VOLUME_NOTIFICATION_DATA pNotify) {
+	if (pNotify) {
+		manager->updateCachedState(pNotify->bMuted != FALSE, pNotify->fMasterVolume);
+	}
+	return S_OK;
+}
+
+
+ULONG STDMETHODCALLTYPE AudioNotificationClient::AddRef() {
+	return ++refCount;
+}
+
+
+ULONG STDMETHODCALLTYPE AudioNotificationClient::Release() {
+	ULONG count = --refCount;
+	if (count == 0) {
+		delete this;
+	}
+	return count;
+}
+
+
+HRESULT STDMETHODCALLTYPE AudioNotificationClient::QueryInterface(REFIID riid, VOID** ppvInterface) {
+	if (riid == IID_IUnknown) {
+		AddRef();
+		*ppvInterface = (IUnknown*)this;
+	} else if (riid == __uuidof(IMMNotificationClient)) {
+		AddRef();
+		*ppvInterface = (IMMNotificationClient*)this;
+	} else {
+		*ppvInterface = NULL;
+		return E_NOINTERFACE;
+	}
+	return S_OK;
+}
+
+
+// None of these must block, the actual rebind happens on the audio command worker.
+HRESULT STDMETHODCALLTYPE AudioNotificationClient::OnDefaultDeviceChanged(EDataFlow flow, ERole role, LPCWSTR pwstrDeviceId) {
+	if (flow == eCapture && role == eCommunications && manager->deviceSelection.mode != AudioDeviceSelection::MODE_LIST) {
+		manager->notifyDeviceChanged();
+	}
+	return S_OK;
+}
+
+
+HRESULT STDMETHODCALLTYPE AudioNotificationClient::OnDeviceAdded(LPCWSTR pwstrDeviceId) {
+	return OnDeviceStateChanged(pwstrDeviceId, DEVICE_STATE_ACTIVE);
+}
+
+
+HRESULT STDMETHODCALLTYPE AudioNotificationClient::OnDeviceRemoved(LPCWSTR pwstrDeviceId) {
+	return OnDeviceStateChanged(pwstrDeviceId, DEVICE_STATE_NOTPRESENT);
+}
+
+
+HRESULT STDMETHODCALLTYPE AudioNotificationClient::OnDeviceStateChanged(LPCWSTR pwstrDeviceId, DWORD dwNewState) {
+	// the set of selected devices might have changed, rebindDevice() ignores it when it did not
+	if (manager->deviceSelection.mode != AudioDeviceSelection::MODE_DEFAULT) {
+		manager->notifyDeviceChanged();
+	}
+	return S_OK;
+}
+
+
+EndpointWorker::EndpointWorker(IAudioEndpointVolume* volume) : volume(volume) {
+	thread = std::thread(&EndpointWorker::run, this);
+}
+
+
+EndpointWorker::~EndpointWorker() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopRequested = true;
+	}
+	condition.notify_one();
+	thread.join();
+}
+
+
+std::shared_future<bool> EndpointWorker::setMuted(bool mute) {
+	return postCommand(mutex, condition, muteMailbox, mute);
+}
+
+
+std::shared_future<bool> EndpointWorker::setMasterVolume(float value) {
+	return postCommand(mutex, condition, volumeMailbox, value);
+}
+
+
+void EndpointWorker::run() {
+	CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		if (muteMailbox.pending) {
+			executeCommand(lock, muteMailbox, [this](bool mute) {
+				return volume->SetMute(mute, nullptr) >= 0;
+			});
+		} else if (volumeMailbox.pending) {
+			executeCommand(lock, volumeMailbox, [this](float value) {
+				return volume->SetMasterVolumeLevelScalar(value, nullptr) >= 0;
+			});
+		} else if (stopRequested) {
+			break;
+		} else {
+			condition.wait(lock);
+		}
+	}
+	lock.unlock();
+	CoUninitialize();
+}
+
+
+namespace {
+
+std::string toUtf8(LPCWSTR value) {
+	int size = WideCharToMultiByte(CP_UTF8, 0, value, -1, nullptr, 0, nullptr, nullptr);
+	if (size <= 0) {
+		return std::string();
+	}
+	std::string retval(size - 1, '\0');
+	WideCharToMultiByte(CP_UTF8, 0, value, -1, &retval[0], size, nullptr, nullptr);
+	return retval;
+}
+
+std::wstring fromUtf8(const std::string& value) {
+	int size = MultiByteToWideChar(CP_UTF8, 0, value.c_str(), -1, nullptr, 0);
+	if (size <= 0) {
+		return std::wstring();
+	}
+	std::wstring retval(size - 1, L'\0');
+	MultiByteToWideChar(CP_UTF8, 0, value.c_str(), -1, &retval[0], size);
+	return retval;
+}
+
+} // anonymous namespace
+
+
+
 AudioManagerWindows::~AudioManagerWindows() {
-	if (audioEndpointVolume) {
-		audioEndpointVolume->Release();
+	if (audioNotificationClient) {
+		audioDeviceEnumerator->UnregisterEndpointNotificationCallback(audioNotificationClient);
+		audioNotificationClient->Release();
+	}
+	releaseDevices();
+	if (audioEndpointVolumeCallback) {
+		audioEndpointVolumeCallback->Release();
 	}
-	if (audioDevice) {
-		audioDevice->Release();
+	if (audioDeviceEnumerator) {
+		audioDeviceEnumerator->Release();
 	}
-	audioDeviceEnumerator->Release();
 }
 
 void AudioManagerWindows::init(OverlayController* controller) {
@@ -21,22 +195,41 @@ void AudioManagerWindows::init(OverlayController* controller) {
 	if (!audioDeviceEnumerator) {
 		throw std::exception("Could not create audio device enumerator");
 	}
-	audioDevice = getDefaultRecordingDevice(audioDeviceEnumerator);
-	if (audioDevice) {
-		audioEndpointVolume = getAudioEndpointVolume(audioDevice);
-	} else {
-		LOG(WARNING) << "Could not find a default recording device.";
-	}
 	this->controller = controller;
+	logRecordingDevices();
+	audioEndpointVolumeCallback = new AudioEndpointVolumeCallback(this);
+	bindDevices(getSelectedDeviceIds());
+	audioNotificationClient = new AudioNotificationClient(this);
+	if (audioDeviceEnumerator->RegisterEndpointNotificationCallback(audioNotificationClient) < 0) {
+		LOG(WARNING) << "Could not register for audio device notifications, device changes will not be noticed.";
+		audioNotificationClient->Release();
+		audioNotificationClient = nullptr;
+	}
+}
+
+bool AudioManagerWindows::rebindDevice() {
+	auto ids = getSelectedDeviceIds();
+	if (ids.size() == endpoints.size()) {
+		bool same = true;
+		for (size_t i = 0; i < ids.size() && same; i++) {
+			same = ids[i] == endpoints[i].id;
+		}
+		if (same) {
+			return false;
+		}
+	}
+	releaseDevices();
+	bindDevices(ids);
+	return !endpoints.empty();
 }
 
 bool AudioManagerWindows::isValid() {
-	return audioEndpointVolume != nullptr;
+	return !endpoints.empty();
 }
 
 bool AudioManagerWindows::isMuted() {
 	BOOL value;
-	if (audioEndpointVolume && audioEndpointVolume->GetMute(&value) >= 0) {
+	if (!endpoints.empty() && endpoints[0].volume->GetMute(&value) >= 0) {
 		return value;
 	} else {
 		return false;
@@ -44,17 +237,23 @@ bool AudioManagerWindows::isMuted() {
 }
 
 bool AudioManagerWindows::setMuted(const bool & mute) {
-	if (audioEndpointVolume) {
-		if (audioEndpointVolume->SetMute(mute, nullptr) >= 0) {
-			return true;
-		}
+	if (endpoints.empty()) {
+		return false;
+	}
+	std::vector<std::shared_future<bool>> results;
+	for (auto& e : endpoints) {
+		results.push_back(e.worker->setMuted(mute));
+	}
+	if (waitForEndpoints(results)) {
+		updateCachedMuted(mute);
+		return true;
 	}
 	return false;
 }
 
 float AudioManagerWindows::getMasterVolume() {
 	float value;
-	if (audioEndpointVolume && audioEndpointVolume->GetMasterVolumeLevelScalar(&value) >= 0) {
+	if (!endpoints.empty() && endpoints[0].volume->GetMasterVolumeLevelScalar(&value) >= 0) {
 		return value;
 	} else {
 		return 0.0;
@@ -62,14 +261,31 @@ float AudioManagerWindows::getMasterVolume() {
 }
 
 bool AudioManagerWindows::setMasterVolume(float value) {
-	if (audioEndpointVolume) {
-		if (audioEndpointVolume->SetMasterVolumeLevelScalar(value, nullptr) >= 0) {
-			return true;
-		}
+	if (endpoints.empty()) {
+		return false;
+	}
+	std::vector<std::shared_future<bool>> results;
+	for (auto& e : endpoints) {
+		results.push_back(e.worker->setMasterVolume(value));
+	}
+	if (waitForEndpoints(results)) {
+		updateCachedMasterVolume(value);
+		return true;
 	}
 	return false;
 }
 
+// All endpoints, the primary one included, run in parallel on their workers, so that the total latency is that of the
+// slowest device instead of the sum and every endpoint sees the commands in the same order.
+// Returns true when the call succeeded on all of them.
+bool AudioManagerWindows::waitForEndpoints(std::vector<std::shared_future<bool>>& results) {
+	bool success = true;
+	for (auto& r : results) {
+		success = r.get() && success;
+	}
+	return success;
+}
+
 IMMDeviceEnumerator* AudioManagerWindows::getAudioDeviceEnumerator() {
 	IMMDeviceEnumerator* pEnumerator;
 	if (CoCreateInstance(__uuidof(MMDeviceEnumerator), NULL, CLSCTX_ALL, __uuidof(IMMDeviceEnumerator), (void**)&pEnumerator) < 0) {
@@ -86,6 +302,137 @@ IMMDevice* AudioManagerWindows::getDefaultRecordingDevice(IMMDeviceEnumerator* d
 	return pDefCapture;
 }
 
+IMMDeviceCollection* AudioManagerWindows::getActiveRecordingDevices(IMMDeviceEnumerator* deviceEnumerator) {
+	IMMDeviceCollection* pCollection;
+	if (deviceEnumerator->EnumAudioEndpoints(eCapture, DEVICE_STATE_ACTIVE, &pCollection) < 0) {
+		return nullptr;
+	}
+	return pCollection;
+}
+
+std::wstring AudioManagerWindows::getDeviceId(IMMDevice* device) {
+	LPWSTR id = nullptr;
+	std::wstring retval;
+	if (device->GetId(&id) >= 0) {
+		retval = id;
+	}
+	CoTaskMemFree(id);
+	return retval;
+}
+
+std::string AudioManagerWindows::getDeviceName(IMMDevice* device) {
+	IPropertyStore* pProps;
+	std::string retval;
+	if (device->OpenPropertyStore(STGM_READ, &pProps) >= 0) {
+		PROPVARIANT name;
+		PropVariantInit(&name);
+		if (pProps->GetValue(PKEY_Device_FriendlyName, &name) >= 0 && name.vt == VT_LPWSTR) {
+			retval = toUtf8(name.pwszVal);
+		}
+		PropVariantClear(&name);
+		pProps->Release();
+	}
+	return retval;
+}
+
+// The default device (if selected) always comes first.
+std::vector<std::wstring> AudioManagerWindows::getSelectedDeviceIds() {
+	std::vector<std::wstring> ids;
+	if (deviceSelection.mode != AudioDeviceSelection::MODE_LIST) {
+		IMMDevice* device = getDefaultRecordingDevice(audioDeviceEnumerator);
+		if (device) {
+			ids.push_back(getDeviceId(device));
+			device->Release();
+		}
+	}
+	if (deviceSelection.mode == AudioDeviceSelection::MODE_ALL) {
+		IMMDeviceCollection* devices = getActiveRecordingDevices(audioDeviceEnumerator);
+		UINT count = 0;
+		if (devices && devices->GetCount(&count) >= 0) {
+			for (UINT i = 0; i < count; i++) {
+				IMMDevice* device;
+				if (devices->Item(i, &device) >= 0) {
+					auto id = getDeviceId(device);
+					if (std::find(ids.begin(), ids.end(), id) == ids.end()) {
+						ids.push_back(id);
+					}
+					device->Release();
+				}
+			}
+		}
+		if (devices) {
+			devices->Release();
+		}
+	} else if (deviceSelection.mode == AudioDeviceSelection::MODE_LIST) {
+		for (auto& id : deviceSelection.ids) {
+			ids.push_back(fromUtf8(id));
+		}
+	}
+	return ids;
+}
+
+void AudioManagerWindows::bindDevices(const std::vector<std::wstring>& ids) {
+	for (auto& id : ids) {
+		IMMDevice* device;
+		DWORD state;
+		if (audioDeviceEnumerator->GetDevice(id.c_str(), &device) < 0) {
+			LOG(WARNING) << "Could not find recording device " << toUtf8(id.c_str()) << ".";
+			continue;
+		}
+		if (device->GetState(&state) < 0 || state != DEVICE_STATE_ACTIVE) {
+			LOG(WARNING) << "Recording device \"" << getDeviceName(device) << "\" is not active.";
+			device->Release();
+			continue;
+		}
+		IAudioEndpointVolume* volume = getAudioEndpointVolume(device);
+		if (!volume) {
+			LOG(WARNING) << "Could not get the endpoint volume of recording device \"" << getDeviceName(device) << "\".";
+			device->Release();
+			continue;
+		}
+		LOG(INFO) << "Using recording device \"" << getDeviceName(device) << "\".";
+		std::unique_ptr<EndpointWorker> worker(new EndpointWorker(volume));
+		endpoints.push_back({ id, device, volume, std::move(worker) });
+	}
+	if (endpoints.empty()) {
+		LOG(WARNING) << "Could not find a recording device.";
+		return;
+	}
+	updateCachedState(isMuted(), getMasterVolume());
+	if (endpoints[0].volume->RegisterControlChangeNotify(audioEndpointVolumeCallback) < 0) {
+		LOG(WARNING) << "Could not register for endpoint volume notifications.";
+	}
+}
+
+void AudioManagerWindows::releaseDevices() {
+	if (!endpoints.empty()) {
+		endpoints[0].volume->UnregisterControlChangeNotify(audioEndpointVolumeCallback);
+	}
+	for (auto& e : endpoints) {
+		e.worker.reset(); // executes its pending commands, it must be gone before the volume interface
+		e.volume->Release();
+		e.device->Release();
+	}
+	endpoints.clear();
+}
+
+void AudioManagerWindows::logRecordingDevices() {
+	IMMDeviceCollection* devices = getActiveRecordingDevices(audioDeviceEnumerator);
+	UINT count = 0;
+	if (devices && devices->GetCount(&count) >= 0) {
+		for (UINT i = 0; i < count; i++) {
+			IMMDevice* device;
+			if (devices->Item(i, &device) >= 0) {
+				LOG(INFO) << "Found recording device \"" << getDeviceName(device) << "\" (id: " << toUtf8(getDeviceId(device).c_str()) << ").";
+				device->Release();
+			}
+		}
+	}
+	if (devices) {
+		devices->Release();
+	}
+}
+
 IAudioEndpointVolume * AudioManagerWindows::getAudioEndpointVolume(IMMDevice* device) {
 	IAudioEndpointVolume * pEndpointVolume;
 	if (device->Activate(__uuidof(IAudioEndpointVolume), CLSCTX_INPROC_SERVER, NULL, (void**)&pEndpointVolume) < 0) {
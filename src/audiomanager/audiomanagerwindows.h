@@ -1,6 +1,15 @@
 #pragma once
 
 #include "../audiomanager.h"
+#include "../audiocommandworker.h"
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include <Mmdeviceapi.h>
 #include <Functiondiscoverykeys_devpkey.h>
@@ -10,13 +19,88 @@
 // application namespace
 namespace miccontrol {
 
+class AudioManagerWindows;
+
+// Forwards endpoint volume/mute changes (no matter who made them) to the audio manager's state cache.
+class AudioEndpointVolumeCallback : public IAudioEndpointVolumeCallback {
+private:
+	std::atomic<ULONG> refCount;
+	AudioManagerWindows* manager;
+
+public:
+	AudioEndpointVolumeCallback(AudioManagerWindows* manager) : refCount(1), manager(manager) {}
+
+	ULONG STDMETHODCALLTYPE AddRef() override;
+	ULONG STDMETHODCALLTYPE Release() override;
+	HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, VOID** ppvInterface) override;
+	HRESULT STDMETHODCALLTYPE OnNotify(PAUDIO_VOLUME_NOTIFICATION_DATA pNotify) override;
+};
+
+
+// Tells the audio manager when the default communications recording device or the set of active devices changed.
+class AudioNotificationClient : public IMMNotificationClient {
+private:
+	std::atomic<ULONG> refCount;
+	AudioManagerWindows* manager;
+
+public:
+	AudioNotificationClient(AudioManagerWindows* manager) : refCount(1), manager(manager) {}
+
+	ULONG STDMETHODCALLTYPE AddRef() override;
+	ULONG STDMETHODCALLTYPE Release() override;
+	HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, VOID** ppvInterface) override;
+
+	HRESULT STDMETHODCALLTYPE OnDefaultDeviceChanged(EDataFlow flow, ERole role, LPCWSTR pwstrDeviceId) override;
+	HRESULT STDMETHODCALLTYPE OnDeviceAdded(LPCWSTR pwstrDeviceId) override;
+	HRESULT STDMETHODCALLTYPE OnDeviceRemoved(LPCWSTR pwstrDeviceId) override;
+	HRESULT STDMETHODCALLTYPE OnDeviceStateChanged(LPCWSTR pwstrDeviceId, DWORD dwNewState) override;
+	HRESULT STDMETHODCALLTYPE OnPropertyValueChanged(LPCWSTR pwstrDeviceId, const PROPERTYKEY key) override {
+		return S_OK;
+	}
+};
+
+
+// Sets one endpoint on its own long-lived thread (COM is initialized once), so that several endpoints are set in
+// parallel without paying for a new thread per call. Uses the same latest-wins mailboxes as AudioCommandWorker.
+class EndpointWorker {
+private:
+	IAudioEndpointVolume* volume;
+	std::mutex mutex;
+	std::condition_variable condition;
+	CommandMailbox<bool> muteMailbox;
+	CommandMailbox<float> volumeMailbox;
+	bool stopRequested = false;
+	std::thread thread;
+
+public:
+	// the volume interface must outlive the worker
+	EndpointWorker(IAudioEndpointVolume* volume);
+	// executes all pending commands before returning
+	~EndpointWorker();
+
+	std::shared_future<bool> setMuted(bool mute);
+	std::shared_future<bool> setMasterVolume(float value);
+
+private:
+	void run();
+};
+
+
 class AudioManagerWindows : public AudioManager {
 friend class AudioNotificationClient;
+friend class AudioEndpointVolumeCallback;
 private:
-	OverlayController* controller = nullptr;
+	struct Endpoint {
+		std::wstring id;
+		IMMDevice* device;
+		IAudioEndpointVolume* volume;
+		std::unique_ptr<EndpointWorker> worker;
+	};
+
 	IMMDeviceEnumerator* audioDeviceEnumerator = nullptr;
-	IMMDevice* audioDevice = nullptr;
-	IAudioEndpointVolume* audioEndpointVolume = nullptr;
+	std::vector<Endpoint> endpoints; // the first one is the primary device, only accessed from the audio command worker after init()
+	AudioEndpointVolumeCallback* audioEndpointVolumeCallback = nullptr;
+	AudioNotificationClient* audioNotificationClient = nullptr;
 
 public:
 	~AudioManagerWindows();
@@ -30,10 +114,20 @@ public:
 	float getMasterVolume() override;
 	bool setMasterVolume(float value) override;
 
+	bool rebindDevice() override;
+
 private:
 	IMMDeviceEnumerator* getAudioDeviceEnumerator();
 	IMMDevice* getDefaultRecordingDevice(IMMDeviceEnumerator* deviceEnumerator);
+	IMMDeviceCollection* getActiveRecordingDevices(IMMDeviceEnumerator* deviceEnumerator);
 	IAudioEndpointVolume* getAudioEndpointVolume(IMMDevice* device);
+	std::wstring getDeviceId(IMMDevice* device);
+	std::string getDeviceName(IMMDevice* device);
+	std::vector<std::wstring> getSelectedDeviceIds();
+	void bindDevices(const std::vector<std::wstring>& ids);
+	void releaseDevices();
+	void logRecordingDevices();
+	bool waitForEndpoints(std::vector<std::shared_future<bool>>& results);
 };
 
 }
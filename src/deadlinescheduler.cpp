@@ -0,0 +1,81 @@
+#include "deadlinescheduler.h"
+
+#ifdef _WIN32
+	#include <windows.h>
+#endif
+
+
+// application namespace
+namespace miccontrol {
+
+DeadlineScheduler::DeadlineScheduler() {
+	thread = std::thread(&DeadlineScheduler::run, this);
+}
+
+
+DeadlineScheduler::~DeadlineScheduler() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopRequested = true;
+	}
+	condition.notify_one();
+	thread.join();
+}
+
+
+DeadlineScheduler::TimerId DeadlineScheduler::schedule(Clock::time_point deadline, std::function<void()> callback) {
+	TimerId id;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		id = nextTimerId++;
+		timers.insert(std::make_pair(deadline, Timer{ id, callback }));
+	}
+	condition.notify_one();
+	return id;
+}
+
+
+bool DeadlineScheduler::cancel(TimerId id) {
+	std::lock_guard<std::mutex> lock(mutex);
+	for (auto it = timers.begin(); it != timers.end(); ++it) {
+		if (it->second.id == id) {
+			timers.erase(it);
+			return true;
+		}
+	}
+	return false;
+}
+
+
+void DeadlineScheduler::cancelAll() {
+	std::lock_guard<std::mutex> lock(mutex);
+	timers.clear();
+}
+
+
+void DeadlineScheduler::run() {
+#ifdef _WIN32
+	// without this waits are rounded up to the ~15ms scheduler tick
+	timeBeginPeriod(1);
+#endif
+	std::unique_lock<std::mutex> lock(mutex);
+	while (!stopRequested) {
+		if (timers.empty()) {
+			condition.wait(lock);
+		} else if (Clock::now() < timers.begin()->first) {
+			condition.wait_until(lock, timers.begin()->first);
+		} else {
+			auto callback = std::move(timers.begin()->second.callback);
+			timers.erase(timers.begin());
+			// run the callback unlocked so that it may schedule/cancel timers itself
+			lock.unlock();
+			callback();
+			lock.lock();
+		}
+	}
+#ifdef _WIN32
+	timeEndPeriod(1);
+#endif
+}
+
+} // namespace miccontrol
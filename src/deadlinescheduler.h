@@ -0,0 +1,52 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+
+
+// application namespace
+namespace miccontrol {
+
+// Runs callbacks on a dedicated thread at given deadlines, independent of the Qt event loop.
+// Callbacks must not block for long since they delay all later deadlines.
+class DeadlineScheduler {
+public:
+	typedef std::chrono::steady_clock Clock;
+	typedef uint64_t TimerId; // 0 is never a valid id
+
+private:
+	struct Timer {
+		TimerId id;
+		std::function<void()> callback;
+	};
+
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::multimap<Clock::time_point, Timer> timers; // there are only ever a handful, an ordered map is plenty
+	TimerId nextTimerId = 1;
+	bool stopRequested = false;
+	std::thread thread;
+
+public:
+	DeadlineScheduler();
+	~DeadlineScheduler();
+
+	TimerId schedule(Clock::time_point deadline, std::function<void()> callback);
+	TimerId schedule(Clock::duration delay, std::function<void()> callback) {
+		return schedule(Clock::now() + delay, callback);
+	}
+
+	// returns false when the timer already fired (or is just firing)
+	bool cancel(TimerId id);
+	void cancelAll();
+
+private:
+	void run();
+};
+
+} // namespace miccontrol
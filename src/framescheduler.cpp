@@ -0,0 +1,88 @@
+#include "framescheduler.h"
+#include <algorithm>
+#include <cmath>
+#include "logging.h"
+
+
+// application namespace
+namespace miccontrol {
+
+FrameScheduler::FrameScheduler(RenderCallback renderCallback) : renderCallback(renderCallback) {
+	timer.setSingleShot(true);
+	timer.setTimerType(Qt::PreciseTimer);
+	QObject::connect(&timer, &QTimer::timeout, [this]() {
+		onTimeout();
+	});
+}
+
+
+void FrameScheduler::updateDisplayFrequency() {
+	if (!vr::VRSystem()) {
+		return;
+	}
+	vr::ETrackedPropertyError error = vr::TrackedProp_Success;
+	float frequency = vr::VRSystem()->GetFloatTrackedDeviceProperty(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_DisplayFrequency_Float, &error);
+	if (error == vr::TrackedProp_Success && frequency > 0.0f && frequency != displayFrequency) {
+		LOG(INFO) << "Rendering the overlay at up to " << frequency << " Hz.";
+		displayFrequency = frequency;
+	}
+}
+
+
+void FrameScheduler::requestFrame() {
+	requestedFrames++;
+	if (timer.isActive()) {
+		// the pending frame will include this change
+		coalescedFrames++;
+		return;
+	}
+	int delay = frameDelay();
+	if (delay <= 0) {
+		onTimeout();
+	} else {
+		timer.start(delay);
+	}
+}
+
+
+int FrameScheduler::frameDelay() {
+	float period = 1.0f / displayFrequency;
+	float sinceVsync = 0.0f;
+	uint64_t frame = 0;
+	if (vr::VRSystem() && vr::VRSystem()->GetTimeSinceLastVsync(&sinceVsync, &frame)) {
+		if (!lastFrameValid || frame != lastFrame) {
+			return 0;
+		}
+		// round up, waking up before the vsync would only cost another timer round
+		return std::max(1, (int)std::ceil((period - sinceVsync) * 1000.0f));
+	}
+	// without vsync information we just keep one frame period between renders
+	if (!lastFrameValid) {
+		return 0;
+	}
+	float elapsed = std::chrono::duration<float>(Clock::now() - lastRenderTime).count();
+	return elapsed >= period ? 0 : (int)std::ceil((period - elapsed) * 1000.0f);
+}
+
+
+void FrameScheduler::onTimeout() {
+	int delay = frameDelay();
+	if (delay > 0) {
+		// woke up a bit before the vsync
+		timer.start(delay);
+		return;
+	}
+	if (!renderCallback()) {
+		skippedFrames++;
+		return;
+	}
+	renderedFrames++;
+	lastRenderTime = Clock::now();
+	float sinceVsync;
+	lastFrameValid = true;
+	if (!vr::VRSystem() || !vr::VRSystem()->GetTimeSinceLastVsync(&sinceVsync, &lastFrame)) {
+		lastFrame = 0;
+	}
+}
+
+} // namespace miccontrol
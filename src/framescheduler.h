@@ -0,0 +1,66 @@
+#pragma once
+
+#include <openvr.h>
+#include <QTimer>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+
+// application namespace
+namespace miccontrol {
+
+// Coalesces render requests so that the overlay is rendered at most once per display frame.
+// The first request within a display frame is rendered right away, later ones are deferred to the next vsync.
+// Lives on the GUI thread.
+class FrameScheduler {
+public:
+	typedef std::chrono::steady_clock Clock;
+	// returns whether a frame was actually rendered
+	typedef std::function<bool()> RenderCallback;
+
+private:
+	RenderCallback renderCallback;
+	QTimer timer;
+	float displayFrequency = 90.0f; // Hz
+
+	bool lastFrameValid = false;
+	uint64_t lastFrame = 0; // vsync counter of the last rendered frame
+	Clock::time_point lastRenderTime;
+
+	uint64_t requestedFrames = 0;
+	uint64_t renderedFrames = 0;
+	uint64_t coalescedFrames = 0; // requests merged into a frame that was already pending
+	uint64_t skippedFrames = 0; // frames the render callback had nothing to render for
+
+public:
+	FrameScheduler(RenderCallback renderCallback);
+
+	// re-reads the display frequency of the HMD
+	void updateDisplayFrequency();
+	float getDisplayFrequency() const {
+		return displayFrequency;
+	}
+
+	void requestFrame();
+
+	uint64_t getRequestedFrames() const {
+		return requestedFrames;
+	}
+	uint64_t getRenderedFrames() const {
+		return renderedFrames;
+	}
+	uint64_t getCoalescedFrames() const {
+		return coalescedFrames;
+	}
+	uint64_t getSkippedFrames() const {
+		return skippedFrames;
+	}
+
+private:
+	// ms until the next frame may be rendered, 0 when it may be rendered right away
+	int frameDelay();
+	void onTimeout();
+};
+
+} // namespace miccontrol
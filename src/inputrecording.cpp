@@ -0,0 +1,169 @@
+#include "inputrecording.h"
+#include <cstring>
+#include "pttpredicate.h"
+#include "logging.h"
+
+
+// application namespace
+namespace miccontrol {
+
+InputRecorder::~InputRecorder() {
+	close();
+}
+
+
+bool InputRecorder::open(const QString& path) {
+	close();
+	file.setFileName(path);
+	if (!file.open(QIODevice::ReadWrite | QIODevice::Truncate)) {
+		LOG(ERROR) << "Could not open controller input recording \"" << path.toStdString() << "\": " << file.errorString().toStdString();
+		return false;
+	}
+	if (!resize(growSamples)) {
+		file.close();
+		return false;
+	}
+	InputRecordingHeader* h = header();
+	h->magic = InputRecordingHeader::magicValue;
+	h->version = InputRecordingHeader::currentVersion;
+	h->sampleSize = sizeof(InputSample);
+	h->reserved = 0;
+	h->sampleCount = 0;
+	h->startTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	startTime = Clock::now();
+	lastStateValid[0] = lastStateValid[1] = false;
+	failed = false;
+	LOG(INFO) << "Recording controller input to \"" << path.toStdString() << "\".";
+	return true;
+}
+
+
+void InputRecorder::record(unsigned hand, vr::TrackedDeviceIndex_t deviceId, Clock::time_point time, const vr::VRControllerState_t& state) {
+	if (!mapping || hand > 1) {
+		return;
+	}
+	if (lastStateValid[hand] && std::memcmp(&lastState[hand], &state, sizeof(state)) == 0) {
+		return;
+	}
+	uint64_t count = header()->sampleCount;
+	if (count >= capacity && !resize(capacity + growSamples)) {
+		return;
+	}
+	InputSample* sample = reinterpret_cast<InputSample*>(mapping + sizeof(InputRecordingHeader)) + count;
+	sample->time = std::chrono::duration_cast<std::chrono::nanoseconds>(time - startTime).count();
+	sample->hand = hand;
+	sample->deviceId = deviceId;
+	sample->state = state;
+	header()->sampleCount = count + 1;
+	lastState[hand] = state;
+	lastStateValid[hand] = true;
+}
+
+
+void InputRecorder::close() {
+	if (!file.isOpen()) {
+		return;
+	}
+	uint64_t count = getSampleCount();
+	if (mapping) {
+		file.unmap(mapping);
+		mapping = nullptr;
+	}
+	file.resize(sizeof(InputRecordingHeader) + count * sizeof(InputSample));
+	file.close();
+	capacity = 0;
+	LOG(INFO) << "Recorded " << count << " controller input samples to \"" << file.fileName().toStdString() << "\".";
+}
+
+
+// The mapping has to go before the file can be resized (Windows refuses otherwise), so this is slow.
+// It only happens once per growSamples changed states.
+bool InputRecorder::resize(uint64_t newCapacity) {
+	if (failed) {
+		return false;
+	}
+	if (mapping) {
+		file.unmap(mapping);
+		mapping = nullptr;
+	}
+	qint64 size = sizeof(InputRecordingHeader) + newCapacity * sizeof(InputSample);
+	if (!file.resize(size) || !(mapping = file.map(0, size))) {
+		LOG(ERROR) << "Could not grow controller input recording \"" << file.fileName().toStdString() << "\": " << file.errorString().toStdString()
+			<< ", recording stopped.";
+		failed = true;
+		mapping = file.map(0, sizeof(InputRecordingHeader) + capacity * sizeof(InputSample)); // keep what we have
+		return false;
+	}
+	capacity = newCapacity;
+	return true;
+}
+
+
+InputReplayer::~InputReplayer() {
+	if (samples) {
+		file.unmap(reinterpret_cast<uchar*>(const_cast<InputSample*>(samples)) - sizeof(InputRecordingHeader));
+	}
+}
+
+
+bool InputReplayer::open(const QString& path) {
+	file.setFileName(path);
+	if (!file.open(QIODevice::ReadOnly)) {
+		LOG(ERROR) << "Could not open controller input recording \"" << path.toStdString() << "\": " << file.errorString().toStdString();
+		return false;
+	}
+	qint64 size = file.size();
+	const uchar* mapping = size >= (qint64)sizeof(InputRecordingHeader) ? file.map(0, size) : nullptr;
+	if (!mapping) {
+		LOG(ERROR) << "Could not map controller input recording \"" << path.toStdString() << "\".";
+		return false;
+	}
+	const InputRecordingHeader* header = reinterpret_cast<const InputRecordingHeader*>(mapping);
+	uint64_t available = (size - sizeof(InputRecordingHeader)) / sizeof(InputSample);
+	if (header->magic != InputRecordingHeader::magicValue || header->version != InputRecordingHeader::currentVersion
+			|| header->sampleSize != sizeof(InputSample) || header->sampleCount > available) {
+		LOG(ERROR) << "\"" << path.toStdString() << "\" is not a controller input recording of this build.";
+		file.unmap(const_cast<uchar*>(mapping));
+		return false;
+	}
+	samples = reinterpret_cast<const InputSample*>(mapping + sizeof(InputRecordingHeader));
+	sampleCount = header->sampleCount;
+	position = 0;
+	current[0] = current[1] = nullptr;
+	LOG(INFO) << "Loaded " << sampleCount << " controller input samples (" << getDuration() / 1000000 << " ms) from \"" << path.toStdString() << "\".";
+	return true;
+}
+
+
+void InputReplayer::advance(int64_t time) {
+	while (position < sampleCount && samples[position].time <= time) {
+		const InputSample& sample = samples[position++];
+		if (sample.hand <= 1) {
+			current[sample.hand] = &sample;
+		}
+	}
+}
+
+
+double InputReplayer::benchmark(const PttPredicate& predicate, unsigned repetitions) const {
+	if (!sampleCount || !repetitions) {
+		return 0.0;
+	}
+	unsigned active = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (unsigned r = 0; r < repetitions; r++) {
+		uint8_t padSector[2] = { PttPredicate::padSectorNone, PttPredicate::padSectorNone };
+		for (uint64_t i = 0; i < sampleCount; i++) {
+			const InputSample& sample = samples[i];
+			active += predicate.evaluate(sample.state, padSector[sample.hand & 1]);
+			active += predicate.isImminent(sample.state);
+		}
+	}
+	auto elapsed = std::chrono::steady_clock::now() - start;
+	// keeps the compiler from dropping the loop
+	volatile unsigned sink = active;
+	(void)sink;
+	return std::chrono::duration<double, std::nano>(elapsed).count() / ((double)sampleCount * repetitions);
+}
+
+} // namespace miccontrol
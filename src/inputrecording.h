@@ -0,0 +1,110 @@
+#pragma once
+
+#include <openvr.h>
+#include <QFile>
+#include <chrono>
+#include <cstdint>
+
+
+// application namespace
+namespace miccontrol {
+
+class PttPredicate;
+
+// Binary controller input recordings: a header followed by fixed-size samples, both written straight into a
+// memory-mapped file. The header's sample count is updated after every sample, so a recording stays readable
+// even when the application does not shut down cleanly.
+struct InputRecordingHeader {
+	static constexpr uint32_t magicValue = 0x5249434D; // "MCIR"
+	static constexpr uint32_t currentVersion = 1;
+
+	uint32_t magic;
+	uint32_t version;
+	uint32_t sampleSize; // sizeof(InputSample) of the writer, the state layout differs between 32 and 64 bit builds
+	uint32_t reserved;
+	uint64_t sampleCount;
+	int64_t startTime; // ns since the epoch (system clock), to match recordings with log files
+};
+
+struct InputSample {
+	int64_t time; // ns since the start of the recording
+	uint32_t hand; // 0 .. left, 1 .. right
+	uint32_t deviceId;
+	vr::VRControllerState_t state; // unPacketNum is 0 for states assembled from button events
+};
+
+
+// Records controller states as seen by the push-to-talk input thread. Only states that differ from the
+// previous one of the same hand are written, idle controllers cost a memcmp per sample.
+// Not thread-safe, must only be used by one thread.
+class InputRecorder {
+public:
+	typedef std::chrono::steady_clock Clock;
+
+private:
+	static constexpr uint64_t growSamples = 65536; // ~5 MB, about a minute of constant input on both hands
+
+	QFile file;
+	uchar* mapping = nullptr;
+	uint64_t capacity = 0;
+	Clock::time_point startTime;
+	vr::VRControllerState_t lastState[2];
+	bool lastStateValid[2] = { false, false };
+	bool failed = false;
+
+public:
+	~InputRecorder();
+
+	bool open(const QString& path);
+	void record(unsigned hand, vr::TrackedDeviceIndex_t deviceId, Clock::time_point time, const vr::VRControllerState_t& state);
+	// truncates the file to the recorded samples
+	void close();
+
+	uint64_t getSampleCount() const {
+		return mapping ? header()->sampleCount : 0;
+	}
+
+private:
+	bool resize(uint64_t newCapacity);
+	InputRecordingHeader* header() const {
+		return reinterpret_cast<InputRecordingHeader*>(mapping);
+	}
+};
+
+
+// Plays back a recording with its original timing. The file is mapped read-only, samples are not copied.
+class InputReplayer {
+private:
+	QFile file;
+	const InputSample* samples = nullptr;
+	uint64_t sampleCount = 0;
+	uint64_t position = 0;
+	const InputSample* current[2] = { nullptr, nullptr };
+
+public:
+	~InputReplayer();
+
+	bool open(const QString& path);
+
+	// applies all samples up to the given time (ns since the start of the recording)
+	void advance(int64_t time);
+	// latest applied sample of the hand, nullptr before its first one
+	const InputSample* getCurrent(unsigned hand) const {
+		return current[hand];
+	}
+	bool isFinished() const {
+		return position >= sampleCount;
+	}
+
+	uint64_t getSampleCount() const {
+		return sampleCount;
+	}
+	int64_t getDuration() const {
+		return sampleCount ? samples[sampleCount - 1].time : 0;
+	}
+
+	// evaluates every sample with the predicate back to back, returns the average time per sample in ns
+	double benchmark(const PttPredicate& predicate, unsigned repetitions) const;
+};
+
+} // namespace miccontrol
@@ -0,0 +1,168 @@
+#include "latencytracer.h"
+#include <fstream>
+#include <sstream>
+
+
+// application namespace
+namespace miccontrol {
+
+LatencyHistogram::LatencyHistogram() : totalCount(0), maxValue(0) {
+	for (auto& bucket : buckets) {
+		bucket = 0;
+	}
+}
+
+
+void LatencyHistogram::record(uint64_t micros) {
+	buckets[bucketIndex(micros)].fetch_add(1, std::memory_order_relaxed);
+	totalCount.fetch_add(1, std::memory_order_relaxed);
+	uint64_t currentMax = maxValue.load(std::memory_order_relaxed);
+	while (micros > currentMax && !maxValue.compare_exchange_weak(currentMax, micros, std::memory_order_relaxed)) {}
+}
+
+
+void LatencyHistogram::reset() {
+	for (auto& bucket : buckets) {
+		bucket = 0;
+	}
+	totalCount = 0;
+	maxValue = 0;
+}
+
+
+uint64_t LatencyHistogram::percentile(double percent) const {
+	uint64_t total = totalCount;
+	if (total == 0) {
+		return 0;
+	}
+	uint64_t target = (uint64_t)(percent / 100.0 * total + 0.5);
+	if (target < 1) {
+		target = 1;
+	}
+	uint64_t seen = 0;
+	for (unsigned i = 0; i < bucketCount; i++) {
+		seen += buckets[i].load(std::memory_order_relaxed);
+		if (seen >= target) {
+			uint64_t bound = bucketUpperBound(i);
+			return bound < maxValue ? bound : (uint64_t)maxValue;
+		}
+	}
+	return maxValue;
+}
+
+
+// The first two powers of two are stored linearly (values 0 .. 2 * subBucketCount - 1), every following
+// power of two gets subBucketCount buckets of its own.
+unsigned LatencyHistogram::bucketIndex(uint64_t micros) {
+	if (micros < 2 * subBucketCount) {
+		return (unsigned)micros;
+	}
+	unsigned magnitude = 0;
+	for (uint64_t value = micros; value >= 2 * subBucketCount; value >>= 1) {
+		magnitude++;
+	}
+	unsigned index = (magnitude + 1) * subBucketCount + (unsigned)((micros >> magnitude) - subBucketCount);
+	return index < bucketCount ? index : bucketCount - 1;
+}
+
+
+uint64_t LatencyHistogram::bucketUpperBound(unsigned index) {
+	if (index < 2 * subBucketCount) {
+		return index;
+	}
+	unsigned magnitude = index / subBucketCount - 1;
+	uint64_t subBucket = index % subBucketCount + subBucketCount;
+	return ((subBucket + 1) << magnitude) - 1;
+}
+
+
+void LatencyTracer::record(Transition transition, Clock::time_point sample, Clock::time_point decision, Clock::time_point call, Clock::time_point completion) {
+	auto micros = [](Clock::time_point from, Clock::time_point to) -> uint64_t {
+		return to > from ? std::chrono::duration_cast<std::chrono::microseconds>(to - from).count() : 0;
+	};
+	histograms[transition][STAGE_SAMPLE_TO_DECISION].record(micros(sample, decision));
+	histograms[transition][STAGE_DECISION_TO_CALL].record(micros(decision, call));
+	histograms[transition][STAGE_CALL_TO_COMPLETION].record(micros(call, completion));
+	histograms[transition][STAGE_TOTAL].record(micros(sample, completion));
+}
+
+
+void LatencyTracer::reset() {
+	for (auto& transition : histograms) {
+		for (auto& histogram : transition) {
+			histogram.reset();
+		}
+	}
+}
+
+
+std::string LatencyTracer::summary() const {
+	std::ostringstream out;
+	for (int transition = 0; transition < TRANSITION_COUNT; transition++) {
+		for (int stage = 0; stage < STAGE_COUNT; stage++) {
+			const LatencyHistogram& histogram = histograms[transition][stage];
+			out << transitionName((Transition)transition) << " " << stageName((Stage)stage)
+				<< ": count=" << histogram.count()
+				<< " p50=" << histogram.percentile(50.0) << "us"
+				<< " p99=" << histogram.percentile(99.0) << "us"
+				<< " max=" << histogram.max() << "us\n";
+		}
+	}
+	return out.str();
+}
+
+
+bool LatencyTracer::dump(const std::string& path) const {
+	std::ofstream file(path, std::ios::out | std::ios::trunc);
+	if (!file) {
+		return false;
+	}
+	file << summary();
+	// raw buckets, so that the distribution can be plotted: transition stage bucket_upper_bound_us count
+	for (int transition = 0; transition < TRANSITION_COUNT; transition++) {
+		for (int stage = 0; stage < STAGE_COUNT; stage++) {
+			const LatencyHistogram& histogram = histograms[transition][stage];
+			if (!histogram.count()) {
+				continue;
+			}
+			for (unsigned i = 0; i < LatencyHistogram::bucketCount; i++) {
+				uint64_t count = histogram.bucket(i);
+				if (count) {
+					file << transitionName((Transition)transition) << " " << stageName((Stage)stage) << " "
+						<< LatencyHistogram::bucketUpperBound(i) << " " << count << "\n";
+				}
+			}
+		}
+	}
+	return (bool)file;
+}
+
+
+const char* LatencyTracer::stageName(Stage stage) {
+	switch (stage) {
+		case STAGE_SAMPLE_TO_DECISION:
+			return "sample->decision";
+		case STAGE_DECISION_TO_CALL:
+			return "decision->call";
+		case STAGE_CALL_TO_COMPLETION:
+			return "call->completion";
+		case STAGE_TOTAL:
+			return "total";
+		default:
+			return "unknown";
+	}
+}
+
+
+const char* LatencyTracer::transitionName(Transition transition) {
+	switch (transition) {
+		case TRANSITION_UNMUTE:
+			return "unmute";
+		case TRANSITION_MUTE:
+			return "mute";
+		default:
+			return "unknown";
+	}
+}
+
+} // namespace miccontrol
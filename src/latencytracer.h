@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+
+// application namespace
+namespace miccontrol {
+
+// Lock-free log-linear histogram of latencies in microseconds (HDR style: every power of two is split
+// into subBucketCount linear buckets, so the relative error of any reported value stays below 1/subBucketCount).
+class LatencyHistogram {
+public:
+	static constexpr unsigned subBucketBits = 4;
+	static constexpr unsigned subBucketCount = 1 << subBucketBits;
+	static constexpr unsigned exponentCount = 32; // up to ~2^35 us, more than enough
+	static constexpr unsigned bucketCount = exponentCount * subBucketCount;
+
+private:
+	std::atomic<uint64_t> buckets[bucketCount];
+	std::atomic<uint64_t> totalCount;
+	std::atomic<uint64_t> maxValue;
+
+public:
+	LatencyHistogram();
+
+	void record(uint64_t micros);
+	void reset();
+
+	uint64_t count() const {
+		return totalCount;
+	}
+	uint64_t max() const {
+		return maxValue;
+	}
+	uint64_t bucket(unsigned index) const {
+		return buckets[index];
+	}
+	// upper bound of the bucket containing the given percentile (0 - 100)
+	uint64_t percentile(double percent) const;
+
+	static unsigned bucketIndex(uint64_t micros);
+	static uint64_t bucketUpperBound(unsigned index);
+};
+
+
+// Collects per-transition timestamps of the push-to-talk path.
+class LatencyTracer {
+public:
+	typedef std::chrono::steady_clock Clock;
+
+	enum Stage {
+		STAGE_SAMPLE_TO_DECISION = 0, // controller sample to push-to-talk decision
+		STAGE_DECISION_TO_CALL, // decision to AudioManager::setMuted() call (includes attack delay/hold time)
+		STAGE_CALL_TO_COMPLETION, // AudioManager::setMuted() call to its completion
+		STAGE_TOTAL, // controller sample to completion
+		STAGE_COUNT
+	};
+
+	enum Transition {
+		TRANSITION_UNMUTE = 0,
+		TRANSITION_MUTE,
+		TRANSITION_COUNT
+	};
+
+private:
+	LatencyHistogram histograms[TRANSITION_COUNT][STAGE_COUNT];
+
+public:
+	void record(Transition transition, Clock::time_point sample, Clock::time_point decision, Clock::time_point call, Clock::time_point completion);
+	void reset();
+
+	const LatencyHistogram& histogram(Transition transition, Stage stage) const {
+		return histograms[transition][stage];
+	}
+
+	// one line per transition and stage with count, p50, p99 and max in microseconds
+	std::string summary() const;
+	bool dump(const std::string& path) const;
+
+	static const char* stageName(Stage stage);
+	static const char* transitionName(Transition transition);
+};
+
+} // namespace miccontrol
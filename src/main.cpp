@@ -1,10 +1,19 @@
 #include "overlaywidget.h"
 #include "overlaycontroller.h"
 #include <QApplication>
+#include <QCommandLineParser>
 #include <iostream>
 #include "logging.h"
 
-#include "audiomanager/audiomanagerwindows.h"
+#include "overlayrenderer/overlayrenderergl.h"
+#include "overlayrenderer/overlayrendererraster.h"
+#include "audiomanager/audiomanagerfake.h"
+#ifdef _WIN32
+	#include "audiomanager/audiomanagerwindows.h"
+#else
+	#include "audiomanager/audiomanageralsa.h"
+	#include "audiomanager/audiomanagerpulse.h"
+#endif
 
 const char* logConfigFileName = "logging.conf";
 
@@ -22,6 +31,74 @@ const char* logConfigDefault =
 INITIALIZE_EASYLOGGINGPP
 
 
+// The audio backend can be chosen with --audio-backend or the MICCONTROL_AUDIO_BACKEND environment variable.
+std::shared_ptr<miccontrol::AudioManager> createAudioManager(const QCommandLineParser& parser) {
+	QString backend = parser.value("audio-backend");
+	if (backend.isEmpty()) {
+		backend = qgetenv("MICCONTROL_AUDIO_BACKEND");
+	}
+	std::shared_ptr<miccontrol::AudioManager> audioManager;
+	if (backend == "fake") {
+		auto fake = std::make_shared<miccontrol::AudioManagerFake>(miccontrol::FakeAudioConfig::parse(parser.value("fake-audio").toStdString()));
+		// the controller is never destroyed, so write the call log when the event loop ends
+		QObject::connect(qApp, &QCoreApplication::aboutToQuit, [fake]() {
+			fake->writeCallLog();
+		});
+		audioManager = fake;
+	}
+#ifdef _WIN32
+	else if (backend.isEmpty() || backend == "windows") {
+		audioManager = std::make_shared<miccontrol::AudioManagerWindows>();
+	}
+#else
+	else if (backend.isEmpty() || backend == "alsa") {
+		audioManager = std::make_shared<miccontrol::AudioManagerAlsa>(parser.value("alsa-device").toStdString(), parser.value("alsa-element").toStdString());
+	} else if (backend == "pulse") {
+		audioManager = std::make_shared<miccontrol::AudioManagerPulse>();
+	}
+#endif
+	if (!audioManager) {
+		throw std::runtime_error("Unknown audio backend: " + backend.toStdString());
+	}
+	// the command line overrides the stored setting
+	QString devices = parser.value("audio-devices");
+	if (!parser.isSet("audio-devices") && parser.isSet("pulse-source") && backend == "pulse") {
+		// --pulse-source predates --audio-devices and selects a single source
+		QString source = parser.value("pulse-source");
+		devices = source == "@DEFAULT_SOURCE@" ? QString("default") : source;
+	} else if (!parser.isSet("audio-devices")) {
+		QSettings appSettings("matzman666", "microphonecontrol");
+		devices = appSettings.value("audioDevices", "default").toString();
+	}
+	audioManager->setDeviceSelection(miccontrol::AudioDeviceSelection::parse(devices.toStdString()));
+	return audioManager;
+}
+
+
+// The renderer can be chosen with --overlay-renderer or the MICCONTROL_OVERLAY_RENDERER environment variable.
+// When no OpenGL context can be created we fall back to the raster renderer.
+std::unique_ptr<miccontrol::OverlayRenderer> createOverlayRenderer(const QCommandLineParser& parser) {
+	QString name = parser.value("overlay-renderer");
+	if (name.isEmpty()) {
+		name = qgetenv("MICCONTROL_OVERLAY_RENDERER");
+	}
+	if (name.isEmpty() || name == "gl") {
+		std::unique_ptr<miccontrol::OverlayRenderer> renderer(new miccontrol::OverlayRendererGL());
+		try {
+			renderer->init();
+			return renderer;
+		} catch (const std::exception& e) {
+			LOG(WARNING) << e.what() << ", falling back to the raster renderer.";
+		}
+	} else if (name != "raster") {
+		throw std::runtime_error("Unknown overlay renderer: " + name.toStdString());
+	}
+	std::unique_ptr<miccontrol::OverlayRenderer> renderer(new miccontrol::OverlayRendererRaster());
+	renderer->init();
+	return renderer;
+}
+
+
 int main(int argc, char *argv[]) {
 	// Configure logger
 	START_EASYLOGGINGPP(argc, argv);
@@ -38,10 +115,45 @@ int main(int argc, char *argv[]) {
 	LOG(INFO) << "Starting Application.";
 	try {
 		QApplication a(argc, argv);
+
+		QCommandLineParser parser;
+		parser.addHelpOption();
+		parser.addOption(QCommandLineOption("audio-backend", "Audio backend to use (windows, alsa, pulse, fake).", "backend"));
+		parser.addOption(QCommandLineOption("alsa-device", "ALSA mixer device.", "device", "default"));
+		parser.addOption(QCommandLineOption("alsa-element", "ALSA mixer capture element.", "element", "Capture"));
+		parser.addOption(QCommandLineOption("fake-audio", "Behaviour of the fake audio backend, e.g. distribution=normal,latency=2,jitter=0.5,failure=0.01,seed=42,log=calls.csv", "options"));
+		parser.addOption(QCommandLineOption("pulse-source", "PulseAudio source name, same as --audio-devices with a single source.", "source"));
+		parser.addOption(QCommandLineOption("audio-devices", "Recording devices to control (default, all, or a ';'-separated list of device IDs).", "devices"));
+		parser.addOption(QCommandLineOption("overlay-renderer", "Overlay renderer to use (gl, raster).", "renderer"));
+		parser.addOption(QCommandLineOption("benchmark-renderers", "Render the overlay with every available renderer and log the frame times, then exit.", "frames"));
+		parser.process(a);
+
 		miccontrol::OverlayWidget *pOverlayWidget = new miccontrol::OverlayWidget;
-		miccontrol::OverlayController* controller = new miccontrol::OverlayController();
 
-		controller->Init(std::make_shared < miccontrol::AudioManagerWindows >());
+		// before OpenVR and the worker threads are started, so there is nothing to shut down afterwards
+		if (parser.isSet("benchmark-renderers")) {
+			unsigned frames = parser.value("benchmark-renderers").toUInt();
+			QGraphicsScene scene;
+			pOverlayWidget->move(0, 0);
+			scene.addWidget(pOverlayWidget);
+			std::unique_ptr<miccontrol::OverlayRenderer> renderers[] = {
+				std::unique_ptr<miccontrol::OverlayRenderer>(new miccontrol::OverlayRendererGL()),
+				std::unique_ptr<miccontrol::OverlayRenderer>(new miccontrol::OverlayRendererRaster())
+			};
+			for (auto& renderer : renderers) {
+				try {
+					renderer->init();
+				} catch (const std::exception& e) {
+					LOG(WARNING) << "Skipping renderer " << renderer->getName() << ": " << e.what();
+					continue;
+				}
+				miccontrol::OverlayController::benchmarkRenderer(*renderer, scene, pOverlayWidget->size(), frames);
+			}
+			return 0;
+		}
+
+		miccontrol::OverlayController* controller = new miccontrol::OverlayController();
+		controller->Init(createAudioManager(parser), createOverlayRenderer(parser));
 		controller->SetWidget(pOverlayWidget, miccontrol::OverlayController::applicationName, miccontrol::OverlayController::applicationKey);
 
 		std::string manifestPath = QApplication::applicationDirPath().toStdString() + "\\microphonecontrol.vrmanifest";
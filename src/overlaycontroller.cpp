@@ -1,21 +1,19 @@
 #include "overlaycontroller.h"
 #include "overlaywidget.h"
 #include "ui_overlaywidget.h"
-#include <QOpenGLFramebufferObjectFormat>
-#include <QOpenGLPaintDevice>
-#include <QPainter>
 #include <QApplication>
 #include <QtWidgets/QWidget>
 #include <QMouseEvent>
 #include <QtWidgets/QGraphicsSceneMouseEvent>
 #include <QtWidgets/QApplication>
-#include <QOpenGLExtraFunctions>
 #include <QCursor>
 #include <QProcess>
 #include <QMessageBox>
 #include <exception>
+#include <fstream>
 #include <iostream>
 #include <array>
+#include <algorithm>
 #include <cmath>
 #include <openvr.h>
 #include "logging.h"
@@ -28,14 +26,15 @@ namespace miccontrol {
 OverlayController::~OverlayController() {
 	appSettings.sync();
 	m_pPumpEventsTimer.reset();
+	m_pPttInputThread.reset();
+	m_pAudioWorker.reset(); // executes all pending commands
 	vr::VR_Shutdown();
+	m_pFrameScheduler.reset();
 	m_pScene.reset();
-	m_pFbo.reset();
-	m_pOffscreenSurface.reset();
-	m_pOpenGLContext.reset();
+	renderer.reset();
 }
 
-void OverlayController::Init(std::shared_ptr<AudioManager> audioManager) {
+void OverlayController::Init(std::shared_ptr<AudioManager> audioManager, std::unique_ptr<OverlayRenderer> renderer) {
 	// Loading the OpenVR Runtime
 	auto initError = vr::VRInitError_None;
 	vr::VR_Init(&initError, vr::VRApplication_Overlay);
@@ -43,34 +42,29 @@ void OverlayController::Init(std::shared_ptr<AudioManager> audioManager) {
 		throw std::runtime_error(std::string("Failed to initialize OpenVR: " + std::string(vr::VR_GetVRInitErrorAsEnglishDescription(initError))));
 	}
 
-	QSurfaceFormat format;
-	// Qt's QOpenGLPaintDevice is not compatible with OpenGL versions >= 3.0
-	// NVIDIA does not care, but unfortunately AMD does
-	// Are subtle changes to the semantics of OpenGL functions actually covered by the compatibility profile,
-	// and this is an AMD bug?
-	format.setVersion(2, 1);
-	//format.setProfile( QSurfaceFormat::CompatibilityProfile );
-	format.setDepthBufferSize(16);
-	format.setStencilBufferSize(8);
-	format.setSamples(16);
-
-	m_pOpenGLContext.reset(new QOpenGLContext());
-	m_pOpenGLContext->setFormat( format );
-	if (!m_pOpenGLContext->create()) {
-		throw std::runtime_error("Could not create OpenGL context");
-	}
-
-	// create an offscreen surface to attach the context and FBO to
-	m_pOffscreenSurface.reset(new QOffscreenSurface());
-	m_pOffscreenSurface->setFormat(m_pOpenGLContext->format());
-	m_pOffscreenSurface->create();
-	m_pOpenGLContext->makeCurrent( m_pOffscreenSurface.get() );
+	this->renderer = std::move(renderer);
+	this->renderer->setSkipUnchanged(appSettings.value("overlaySkipUnchangedFrames", false).toBool());
+	m_pFrameScheduler.reset(new FrameScheduler([this]() {
+		return renderScene();
+	}));
+	m_pFrameScheduler->updateDisplayFrequency();
 
 	m_pScene.reset(new QGraphicsScene());
 	connect( m_pScene.get(), SIGNAL(changed(const QList<QRectF>&)), this, SLOT( OnSceneChanged(const QList<QRectF>&)) );
 
 	this->audioManager = audioManager;
+	this->audioManager->setStateChangedHandler([this](bool muted, float masterVolume) {
+		notifyAudioStateChanged(muted, masterVolume);
+	});
 	this->audioManager->init(this);
+	float cachedMasterVolume;
+	this->audioManager->getCachedState(micUserMute, cachedMasterVolume);
+	micVolume = (unsigned)std::lround(cachedMasterVolume * 100.0f);
+	// the audio manager may notify us from any thread
+	connect(this, SIGNAL(audioStateChanged(bool, float)), this, SLOT(OnAudioStateChanged(bool, float)), Qt::QueuedConnection);
+	m_pAudioWorker = std::make_shared<AudioCommandWorker>(this->audioManager);
+	micVolumeWriteInterval = std::min(appSettings.value("micVolumeWriteInterval", 10).toUInt(), 1000u);
+	m_pAudioWorker->setVolumeWriteInterval(std::chrono::milliseconds(micVolumeWriteInterval));
 
 	pttEnabled = appSettings.value("pttEnabled", false).toBool();
 	pttNotifyEnabled = appSettings.value("pttNotifyEnabled", true).toBool();
@@ -80,6 +74,141 @@ void OverlayController::Init(std::shared_ptr<AudioManager> audioManager) {
 	pttTriggerModus = appSettings.value("pttTriggerModus", 0).toInt();
 	pttPadModus = appSettings.value("pttPadModus", 0).toInt();
 	pttPadArea = appSettings.value("pttPadArea", 0).toInt();
+	pttPadSectorCount = appSettings.value("pttPadSectorCount", 4).toInt();
+	if (pttPadSectorCount < 1 || pttPadSectorCount > (int)PttPredicate::maxPadSectors) {
+		LOG(WARNING) << "Invalid touchpad sector count " << pttPadSectorCount << ", falling back to 4.";
+		pttPadSectorCount = 4;
+	}
+	// the mask only means something for the sector count it was made for, a hand-written mask without count is taken as is
+	int pttPadSectorMaskCount = appSettings.value("pttPadSectorMaskCount", pttPadSectorCount).toInt();
+	if (!appSettings.contains("pttPadSectorMask") || pttPadSectorMaskCount != pttPadSectorCount) {
+		if (appSettings.contains("pttPadSectorMask")) {
+			LOG(WARNING) << "Touchpad sector mask was made for " << pttPadSectorMaskCount << " sectors, recomputing it from the touchpad areas.";
+		}
+		pttPadSectorMask = PttPredicate::sectorMaskFromPadArea(pttPadArea, pttPadSectorCount);
+	} else {
+		pttPadSectorMask = appSettings.value("pttPadSectorMask").toUInt();
+	}
+	savePttPadSectorMask();
+	pttPadInnerArea = appSettings.value("pttPadInnerArea", false).toBool();
+	pttPadInnerRadius = appSettings.value("pttPadInnerRadius", 0.2f).toFloat();
+	pttPadSectorHysteresis = appSettings.value("pttPadSectorHysteresis", 5.0f).toFloat();
+	pttPadRadialHysteresis = appSettings.value("pttPadRadialHysteresis", 0.03f).toFloat();
+	pttAttackDelay = std::min(appSettings.value("pttAttackDelay", 0).toUInt(), 2000u);
+	pttHoldTime = std::min(appSettings.value("pttHoldTime", 0).toUInt(), 2000u);
+	pttSpeculativeUnmute = appSettings.value("pttSpeculativeUnmute", false).toBool();
+	pttSpeculationWindow = std::min(appSettings.value("pttSpeculationWindow", 200).toUInt(), 2000u);
+	pttSpeculativeTriggerThreshold = appSettings.value("pttSpeculativeTriggerThreshold", 0.1f).toFloat();
+	pttInputRate = appSettings.value("pttInputRate", 500).toUInt();
+	pttLatencyDumpFile = appSettings.value("pttLatencyDumpFile", "").toString();
+	pttInputMode = appSettings.value("pttInputMode", (int)PttInputConfig::INPUT_MODE_POLLING).toInt();
+	pttEventIdleInterval = std::min(appSettings.value("pttEventIdleInterval", 10).toUInt(), 100u);
+
+	m_pPttInputThread.reset(new PttInputThread(m_pAudioWorker, pttInputRate));
+	QString pttInputReplayFile = appSettings.value("pttInputReplayFile", "").toString();
+	QString pttInputRecordFile = appSettings.value("pttInputRecordFile", "").toString();
+	if (!pttInputReplayFile.isEmpty()) {
+		std::unique_ptr<InputReplayer> replayer(new InputReplayer());
+		if (replayer->open(pttInputReplayFile)) {
+			if (appSettings.value("pttInputReplayBenchmark", false).toBool()) {
+				// about a million evaluations, whatever the length of the recording
+				unsigned repetitions = (unsigned)std::max<uint64_t>(1, 1000000 / std::max<uint64_t>(1, replayer->getSampleCount()));
+				LOG(INFO) << "Evaluating a recorded controller input sample takes "
+					<< replayer->benchmark(makePttConfig().predicate, repetitions) << " ns on average.";
+			}
+			m_pPttInputThread->setReplayer(std::move(replayer));
+		}
+		if (!pttInputRecordFile.isEmpty()) {
+			LOG(WARNING) << "Not recording controller input while replaying a recording.";
+		}
+	} else if (!pttInputRecordFile.isEmpty()) {
+		std::unique_ptr<InputRecorder> recorder(new InputRecorder());
+		if (recorder->open(pttInputRecordFile)) {
+			m_pPttInputThread->setRecorder(std::move(recorder));
+		}
+	}
+	publishPttConfig();
+	m_pPttInputThread->start(QThread::TimeCriticalPriority);
+}
+
+
+PttInputConfig OverlayController::makePttConfig() {
+	PttInputConfig config;
+	config.enabled = pttEnabled;
+	config.inputMode = pttInputMode;
+	config.eventIdleInterval = pttEventIdleInterval;
+	config.leftControllerEnabled = pttLeftControllerEnabled;
+	config.rightControllerEnabled = pttRightControllerEnabled;
+	config.digitalButtonMask = pttDigitalButtonMask;
+	config.triggerModus = pttTriggerModus;
+	config.padModus = pttPadModus;
+	config.padArea = pttPadArea;
+	config.padSectorCount = pttPadSectorCount;
+	config.padSectorMask = pttPadSectorMask;
+	// all four areas have always meant the whole touchpad, as long as the mask really covers every sector
+	config.padInnerArea = pttPadInnerArea || (pttPadArea == PttInputConfig::PAD_AREA_ALL
+			&& pttPadSectorMask == PttPredicate::sectorMaskFromPadArea(PttInputConfig::PAD_AREA_ALL, pttPadSectorCount));
+	config.padInnerRadius = pttPadInnerRadius;
+	config.padSectorHysteresis = pttPadSectorHysteresis;
+	config.padRadialHysteresis = pttPadRadialHysteresis;
+	config.attackDelay = pttAttackDelay;
+	config.holdTime = pttHoldTime;
+	config.speculativeUnmute = pttSpeculativeUnmute;
+	config.speculationWindow = pttSpeculationWindow;
+	config.speculativeTriggerThreshold = pttSpeculativeTriggerThreshold;
+	config.predicate.compile(config);
+	return config;
+}
+
+
+void OverlayController::publishPttConfig() {
+	if (m_pPttInputThread) {
+		m_pPttInputThread->setConfig(makePttConfig());
+	}
+}
+
+
+bool OverlayController::dumpPttLatencies(const std::string& path) {
+	if (!m_pPttInputThread) {
+		return false;
+	}
+	if (!m_pPttInputThread->getLatencyTracer().dump(path)) {
+		LOG(ERROR) << "Could not write push-to-talk latencies to \"" << path << "\"";
+		return false;
+	}
+	std::ofstream file(path, std::ios::out | std::ios::app);
+	file << "speculation hits " << m_pPttInputThread->getSpeculationHitCount() << " misses " << m_pPttInputThread->getSpeculationMissCount() << "\n";
+	return true;
+}
+
+
+void OverlayController::logSpeculationStats() {
+	uint64_t hits = m_pPttInputThread->getSpeculationHitCount();
+	uint64_t misses = m_pPttInputThread->getSpeculationMissCount();
+	if (hits || misses) {
+		LOG(INFO) << "Speculative unmutes so far: " << hits << " hits, " << misses << " misses ("
+			<< std::lround(100.0 * hits / (hits + misses)) << "% followed by a press).";
+	}
+}
+
+
+// An area toggle only adds or removes the sectors within its quadrant, the rest of a custom mask stays.
+// Must be called after pttPadArea has been updated.
+void OverlayController::updatePttPadSectors(int area, bool value) {
+	uint32_t sectors = PttPredicate::sectorMaskFromPadArea(area, pttPadSectorCount);
+	if (value) {
+		pttPadSectorMask |= sectors;
+	} else {
+		// diagonal sectors stay as long as the neighbouring area is still enabled
+		pttPadSectorMask &= ~(sectors & ~PttPredicate::sectorMaskFromPadArea(pttPadArea, pttPadSectorCount));
+	}
+	savePttPadSectorMask();
+}
+
+
+void OverlayController::savePttPadSectorMask() {
+	appSettings.setValue("pttPadSectorMask", pttPadSectorMask);
+	appSettings.setValue("pttPadSectorMaskCount", pttPadSectorCount);
 }
 
 
@@ -131,11 +260,7 @@ void OverlayController::SetWidget(OverlayWidget *pWidget, const std::string& nam
 	m_pPumpEventsTimer->setInterval(20);
 	m_pPumpEventsTimer->start();
 
-	QOpenGLFramebufferObjectFormat fboFormat;
-	fboFormat.setAttachment(QOpenGLFramebufferObject::CombinedDepthStencil);
-	fboFormat.setTextureTarget(GL_TEXTURE_2D);
-
-	m_pFbo.reset(new QOpenGLFramebufferObject(pWidget->width(), pWidget->height(), fboFormat));
+	renderer->setSize(pWidget->size());
 
 	vr::HmdVector2_t vecWindowSize = {
 		(float)pWidget->width(),
@@ -158,40 +283,66 @@ void OverlayController::SetWidget(OverlayWidget *pWidget, const std::string& nam
 	connect(m_pWidget->ui->pttToggleButton, SIGNAL(toggled(bool)), this, SLOT(pttEnableToggled(bool)));
 	connect(m_pWidget->ui->micMuteToggle, SIGNAL(toggled(bool)), this, SLOT(MicMuteToggled(bool)));
 	connect(m_pWidget->ui->micVolumeSlider, SIGNAL(valueChanged(int)), this, SLOT(MicVolumeChanged(int)));
+	connect(m_pWidget->ui->micVolumeSlider, SIGNAL(sliderReleased()), this, SLOT(MicVolumeReleased()));
+}
+
+
+void OverlayController::OnSceneChanged( const QList<QRectF>& region ) {
+	// damage is collected even while the overlay is hidden, it gets rendered once the overlay is visible again
+	for (const QRectF& rect : region) {
+		renderer->addDamage(rect);
+	}
+
+	m_pFrameScheduler->requestFrame();
 }
 
 
-void OverlayController::OnSceneChanged( const QList<QRectF>& ) {
+bool OverlayController::renderScene() {
 	// skip rendering if the overlay isn't visible
 	if (!vr::VROverlay() || !vr::VROverlay()->IsOverlayVisible(m_ulOverlayHandle) && !vr::VROverlay()->IsOverlayVisible(m_ulOverlayThumbnailHandle))
-		return;
+		return false;
+	if (!renderer->hasDamage()) {
+		return false;
+	}
 
-	m_pOpenGLContext->makeCurrent(m_pOffscreenSurface.get());
-	m_pFbo->bind();
+	renderer->renderFrame(*m_pScene, m_ulOverlayHandle);
+	return true;
+}
 
-	QOpenGLPaintDevice device(m_pFbo->size());
-	QPainter painter(&device);
-	painter.setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing | QPainter::SmoothPixmapTransform);
 
-	m_pScene->render(&painter);
+void OverlayController::logRenderStats() {
+	const LatencyHistogram& frameTimes = renderer->getFrameTimes();
+	LOG(INFO) << "Renderer " << renderer->getName() << ": " << renderer->getRenderedFrames() << " frames, p50=" << frameTimes.percentile(50.0)
+		<< "us p99=" << frameTimes.percentile(99.0) << "us max=" << frameTimes.max() << "us, repainted "
+		<< std::lround(renderer->getRepaintedFraction() * 100.0) << "% of the frame pixels, " << renderer->getSuppressedFrames()
+		<< " unchanged frames not submitted";
+	LOG(INFO) << "Frame scheduler: " << m_pFrameScheduler->getRequestedFrames() << " frames requested, " << m_pFrameScheduler->getRenderedFrames()
+		<< " rendered, " << m_pFrameScheduler->getCoalescedFrames() << " coalesced into a pending frame, "
+		<< m_pFrameScheduler->getSkippedFrames() << " skipped without damage";
+	LOG(INFO) << "Mouse moves: " << mouseMovesReceived << " received, " << mouseMovesDispatched << " dispatched";
+}
 
-	m_pFbo->release();
 
-	GLuint unTexture = m_pFbo->texture();
-	if (unTexture != 0) {
-#if defined _WIN64 || defined _LP64
-		// To avoid any compiler warning because of cast to a larger pointer type (warning C4312 on VC)
-		vr::Texture_t texture = { (void*)((uint64_t)unTexture), vr::API_OpenGL, vr::ColorSpace_Auto };
-#else
-		vr::Texture_t texture = { (void*)unTexture, vr::API_OpenGL, vr::ColorSpace_Auto };
-#endif
-		vr::VROverlay()->SetOverlayTexture(m_ulOverlayHandle, &texture);
-	}
-	m_pOpenGLContext->functions()->glFlush(); // We need to flush otherwise the texture may be empty.
+void OverlayController::benchmarkRenderer(OverlayRenderer& renderer, QGraphicsScene& scene, const QSize& size, unsigned frames) {
+	renderer.setSize(size);
+	// frames are not submitted, so no overlay is needed
+	renderer.renderFrame(scene, vr::k_ulOverlayHandleInvalid); // warm up caches, glyphs and the like
+	renderer.finish();
+	renderer.resetStats();
+	auto start = LatencyTracer::Clock::now();
+	for (unsigned i = 0; i < frames; i++) {
+		renderer.invalidate(); // full frames, the worst case
+		renderer.renderFrame(scene, vr::k_ulOverlayHandleInvalid);
+	}
+	renderer.finish();
+	auto total = std::chrono::duration_cast<std::chrono::microseconds>(LatencyTracer::Clock::now() - start).count();
+	const LatencyHistogram& frameTimes = renderer.getFrameTimes();
+	LOG(INFO) << "Renderer " << renderer.getName() << ": " << frames << " frames of " << size.width() << "x" << size.height()
+		<< ", p50=" << frameTimes.percentile(50.0) << "us p99=" << frameTimes.percentile(99.0) << "us max=" << frameTimes.max()
+		<< "us, " << (frames ? total / frames : 0) << "us per frame including GPU work";
 }
 
 
-
 void logControllerState(const vr::VRControllerState_t& state, const std::string& prefix) {
 	if (state.ulButtonPressed & vr::ButtonMaskFromId(vr::k_EButton_ApplicationMenu)) {
 		LOG(INFO) << prefix << vr::VRSystem()->GetButtonIdNameFromEnum(vr::k_EButton_ApplicationMenu) << " pressed";
@@ -266,6 +417,34 @@ void logControllerState(const vr::VRControllerState_t& state, const std::string&
 }
 
 
+void OverlayController::flushMouseMove() {
+	if (!mouseMovePending) {
+		return;
+	}
+	mouseMovePending = false;
+	mouseMovesDispatched++;
+
+	QPointF ptNewMouse = m_ptPendingMouse;
+	QPoint ptGlobal = ptNewMouse.toPoint();
+	QGraphicsSceneMouseEvent mouseEvent( QEvent::GraphicsSceneMouseMove );
+	mouseEvent.setWidget( NULL );
+	mouseEvent.setPos( ptNewMouse );
+	mouseEvent.setScenePos( ptGlobal );
+	mouseEvent.setScreenPos( ptGlobal );
+	mouseEvent.setLastPos( m_ptLastMouse );
+	mouseEvent.setLastScenePos( m_pWidget->mapToGlobal( m_ptLastMouse.toPoint() ) );
+	mouseEvent.setLastScreenPos( m_pWidget->mapToGlobal( m_ptLastMouse.toPoint() ) );
+	mouseEvent.setButtons( m_lastMouseButtons );
+	mouseEvent.setButton( Qt::NoButton );
+	mouseEvent.setModifiers( 0 );
+	mouseEvent.setAccepted( false );
+
+	m_ptLastMouse = ptNewMouse;
+	// hover effects repaint through the scene's changed signal, a move by itself needs no frame
+	QApplication::sendEvent( m_pScene.get(), &mouseEvent );
+}
+
+
 
 void OverlayController::OnTimeoutPumpEvents() {
     if( !vr::VRSystem() )
@@ -280,76 +459,20 @@ void OverlayController::OnTimeoutPumpEvents() {
 	}
 	*/
 	
-	static auto handleControllerState = [](const vr::VRControllerState_t& state, OverlayController* controller) -> bool {
-		if (state.ulButtonPressed & controller->pttDigitalButtonMask) {
-			return true;
-		}
-		if (controller->pttTriggerModus) {
-			if ( state.ulButtonPressed & vr::ButtonMaskFromId(vr::k_EButton_SteamVR_Trigger) 
-				|| state.ulButtonTouched & vr::ButtonMaskFromId(vr::k_EButton_SteamVR_Trigger) ) {
-				return true;
-			}
-		}
-		if (controller->pttPadModus) {
-			if ( ( (controller->pttPadModus & 1) && (state.ulButtonTouched & vr::ButtonMaskFromId(vr::k_EButton_SteamVR_Touchpad)) )
-					|| ( (controller->pttPadModus & 2) && (state.ulButtonPressed & vr::ButtonMaskFromId(vr::k_EButton_SteamVR_Touchpad)) ) ) {
-				if (controller->pttPadArea == (PAD_AREA_LEFT + PAD_AREA_TOP + PAD_AREA_RIGHT + PAD_AREA_BOTTOM)) {
-					return true;
-				} else {
-					float x = state.rAxis[0].x;
-					float y = state.rAxis[0].y;
-					if (std::abs(x) >= 0.2 || std::abs(y) >= 0.2) { // deadzone in the middle
-						if (x < 0 && std::abs(y) < -x && (controller->pttPadArea & PAD_AREA_LEFT)) {
-							return true;
-						} else if (y > 0 && std::abs(x) < y && (controller->pttPadArea & PAD_AREA_TOP)) {
-							return true;
-						} else if (x > 0 && std::abs(y) < x && (controller->pttPadArea & PAD_AREA_RIGHT)) {
-							return true;
-						} else if (y < 0 && std::abs(x) < -y && (controller->pttPadArea & PAD_AREA_BOTTOM)) {
-							return true;
-						}
-					}
-				}
-			}
-		}
-		return false;
-	};
-	if (pttEnabled) {
-		bool newState = false;
-		if (pttLeftControllerEnabled) {
-			auto leftId = vr::VRSystem()->GetTrackedDeviceIndexForControllerRole(vr::TrackedControllerRole_LeftHand);
-			if (leftId != vr::k_unTrackedDeviceIndexInvalid) {
-				vr::VRControllerState_t state;
-				if (vr::VRSystem()->GetControllerState(leftId, &state)) {
-					//logControllerState(state, "Left ");
-					newState |= handleControllerState(state, this);
-				}
-			}
-		}
-
-		if (pttRightControllerEnabled) {
-			auto rightId = vr::VRSystem()->GetTrackedDeviceIndexForControllerRole(vr::TrackedControllerRole_RightHand);
-			if (rightId != vr::k_unTrackedDeviceIndexInvalid) {
-				vr::VRControllerState_t state;
-				if (vr::VRSystem()->GetControllerState(rightId, &state)) {
-					//logControllerState(state, "Right ");
-					newState |= handleControllerState(state, this);
-				}
-			}
-		}
-
-		if (newState && !pttActive) {
-			if (audioManager && audioManager->isValid() && audioManager->setMuted(false)) {
-				pttActive = true;
+	// push-to-talk itself is handled by the input thread, we only mirror its state here
+	if (m_pPttInputThread) {
+		bool newState = m_pPttInputThread->isActive();
+		if (newState != pttActive) {
+			pttActive = newState;
+			if (pttActive) {
 				vr::VROverlay()->ShowOverlay(m_ulNotificationOverlayHandle);
-				m_pWidget->ui->micMuteToggle->setChecked((pttEnabled && !pttActive) || micUserMute);
-			}
-		} else if (!newState && pttActive) {
-			if (audioManager && audioManager->isValid() && audioManager->setMuted(true)) {
-				pttActive = false;
+			} else {
 				vr::VROverlay()->HideOverlay(m_ulNotificationOverlayHandle);
-				m_pWidget->ui->micMuteToggle->setChecked((pttEnabled && !pttActive) || micUserMute);
 			}
+			// block signals, otherwise MicMuteToggled would race the input thread
+			m_pWidget->ui->micMuteToggle->blockSignals(true);
+			m_pWidget->ui->micMuteToggle->setChecked((pttEnabled && !pttActive) || micUserMute);
+			m_pWidget->ui->micMuteToggle->blockSignals(false);
 		}
 	}
 
@@ -357,29 +480,15 @@ void OverlayController::OnTimeoutPumpEvents() {
     while( vr::VROverlay()->PollNextOverlayEvent( m_ulOverlayHandle, &vrEvent, sizeof( vrEvent )  ) ) {
 		switch( vrEvent.eventType ) {
 			case vr::VREvent_MouseMove: {
-				QPointF ptNewMouse( vrEvent.data.mouse.x, vrEvent.data.mouse.y );
-				QPoint ptGlobal = ptNewMouse.toPoint();
-				QGraphicsSceneMouseEvent mouseEvent( QEvent::GraphicsSceneMouseMove );
-				mouseEvent.setWidget( NULL );
-				mouseEvent.setPos( ptNewMouse );
-				mouseEvent.setScenePos( ptGlobal );
-				mouseEvent.setScreenPos( ptGlobal );
-				mouseEvent.setLastPos( m_ptLastMouse );
-				mouseEvent.setLastScenePos( m_pWidget->mapToGlobal( m_ptLastMouse.toPoint() ) );
-				mouseEvent.setLastScreenPos( m_pWidget->mapToGlobal( m_ptLastMouse.toPoint() ) );
-				mouseEvent.setButtons( m_lastMouseButtons );
-				mouseEvent.setButton( Qt::NoButton );
-				mouseEvent.setModifiers( 0 );
-				mouseEvent.setAccepted( false );
-
-				m_ptLastMouse = ptNewMouse;
-				QApplication::sendEvent( m_pScene.get(), &mouseEvent );
-
-				OnSceneChanged( QList<QRectF>() );
+				// only the last position of a tick is dispatched, presses and releases flush it first
+				m_ptPendingMouse = QPointF( vrEvent.data.mouse.x, vrEvent.data.mouse.y );
+				mouseMovePending = true;
+				mouseMovesReceived++;
 			}
 			break;
 
 			case vr::VREvent_MouseButtonDown: {
+				flushMouseMove();
 				Qt::MouseButton button = vrEvent.data.mouse.button == vr::VRMouseButton_Right ? Qt::RightButton : Qt::LeftButton;
 
 				m_lastMouseButtons |= button;
@@ -406,6 +515,7 @@ void OverlayController::OnTimeoutPumpEvents() {
 			break;
 
 			case vr::VREvent_MouseButtonUp: {
+				flushMouseMove();
 				Qt::MouseButton button = vrEvent.data.mouse.button == vr::VRMouseButton_Right ? Qt::RightButton : Qt::LeftButton;
 				m_lastMouseButtons &= ~button;
 
@@ -428,6 +538,7 @@ void OverlayController::OnTimeoutPumpEvents() {
 			break;
 
 			case vr::VREvent_OverlayShown: {
+				m_pFrameScheduler->updateDisplayFrequency();
 				m_pWidget->repaint();
 				UpdateWidget();
 			}
@@ -437,7 +548,14 @@ void OverlayController::OnTimeoutPumpEvents() {
 				LOG(INFO) << "Received quit request.";
 				vr::VRSystem()->AcknowledgeQuit_Exiting(); // Let us buy some time just in case
 				m_pPumpEventsTimer->stop();
-				MicMuteToggled(micUserMute);
+				m_pPttInputThread->stop();
+				m_pPttInputThread->wait();
+				if (!pttLatencyDumpFile.isEmpty()) {
+					dumpPttLatencies(pttLatencyDumpFile.toStdString());
+				}
+				logRenderStats();
+				// restore the user's mute state before we go
+				m_pAudioWorker->setMuted(micUserMute).wait();
 				QApplication::exit();
 			}
 			break;
@@ -455,6 +573,7 @@ void OverlayController::OnTimeoutPumpEvents() {
 			break;
 		}
 	}
+	flushMouseMove();
 
     if( m_ulOverlayThumbnailHandle != vr::k_ulOverlayHandleInvalid ) {
         while( vr::VROverlay()->PollNextOverlayEvent( m_ulOverlayThumbnailHandle, &vrEvent, sizeof( vrEvent)  ) ) {
@@ -510,28 +629,19 @@ void OverlayController::UpdateWidget() {
 		m_pWidget->ui->pttTriggerButtonToggle->setChecked(pttTriggerModus >= 1);
 		m_pWidget->ui->pttPadTouchedToggle->setChecked(pttPadModus & 1);
 		m_pWidget->ui->pttPadPressedToggle->setChecked(pttPadModus & 2);
-		m_pWidget->ui->pttPadAreaLeftToggle->setChecked(pttPadArea & PAD_AREA_LEFT);
-		m_pWidget->ui->pttPadAreaTopToggle->setChecked(pttPadArea & PAD_AREA_TOP);
-		m_pWidget->ui->pttPadAreaRightToggle->setChecked(pttPadArea & PAD_AREA_RIGHT);
-		m_pWidget->ui->pttPadAreaBottomToggle->setChecked(pttPadArea & PAD_AREA_BOTTOM);
+		m_pWidget->ui->pttPadAreaLeftToggle->setChecked(pttPadArea & PttInputConfig::PAD_AREA_LEFT);
+		m_pWidget->ui->pttPadAreaTopToggle->setChecked(pttPadArea & PttInputConfig::PAD_AREA_TOP);
+		m_pWidget->ui->pttPadAreaRightToggle->setChecked(pttPadArea & PttInputConfig::PAD_AREA_RIGHT);
+		m_pWidget->ui->pttPadAreaBottomToggle->setChecked(pttPadArea & PttInputConfig::PAD_AREA_BOTTOM);
 		m_pWidget->ui->pttNotifyToggle->setChecked(pttNotifyEnabled);
 		m_pWidget->ui->pttToggleButton->setChecked(pttEnabled);
 		if (pttEnabled) {
 			_setEnabled(true, pptElements, 12); // don't touch the last element
 			m_pWidget->ui->micMuteToggle->setEnabled(false);
-			if (audioManager && audioManager->isValid()) {
-				pttActive = !audioManager->isMuted();
-			} else {
-				pttActive = false;
-			}
+			pttActive = m_pPttInputThread && m_pPttInputThread->isActive();
 		} else {
 			_setEnabled(false, pptElements, 12); // don't touch the last element
 			m_pWidget->ui->micMuteToggle->setEnabled(true);
-			if (audioManager && audioManager->isValid()) {
-				micUserMute = audioManager->isMuted();
-			} else {
-				micUserMute = false;
-			}
 		}
 		m_pWidget->ui->micMuteToggle->setChecked((pttEnabled && !pttActive) || micUserMute);
 		m_pWidget->ui->micVolumeSlider->setValue(micVolume);
@@ -541,9 +651,15 @@ void OverlayController::UpdateWidget() {
 }
 
 
+// Audio calls are executed asynchronously, the state is updated optimistically and failures are only logged.
 void OverlayController::MicMuteToggled(bool value) {
-	if (audioManager && audioManager->isValid()) {
-		if (audioManager->setMuted(value) && !pttEnabled) {
+	if (m_pAudioWorker) {
+		m_pAudioWorker->setMuted(value, [value](bool success, AudioCommandWorker::Clock::time_point) {
+			if (!success) {
+				LOG(WARNING) << "Could not " << (value ? "mute" : "unmute") << " the microphone.";
+			}
+		});
+		if (!pttEnabled) {
 			micUserMute = value;
 		}
 	}
@@ -551,18 +667,69 @@ void OverlayController::MicMuteToggled(bool value) {
 
 
 void OverlayController::MicVolumeChanged(int value) {
-	if (audioManager && audioManager->isValid()) {
+	if (m_pAudioWorker) {
 		float fval = (float)value / 100.0f;
-		if (audioManager->setMasterVolume(fval)) {
-			micVolume = value;
+		m_pAudioWorker->setMasterVolume(fval);
+		micVolume = value;
+	}
+}
+
+
+void OverlayController::MicVolumeReleased() {
+	if (m_pAudioWorker) {
+		m_pAudioWorker->flushMasterVolume();
+	}
+}
+
+
+// micUserMute and micVolume are kept up to date by the audio manager's change notifications, we never query the device.
+void OverlayController::OnAudioStateChanged(bool muted, float masterVolume) {
+	micVolume = (unsigned)std::lround(masterVolume * 100.0f);
+	if (!pttEnabled) {
+		micUserMute = muted;
+	}
+	if (m_pWidget) {
+		m_pWidget->ui->micMuteToggle->blockSignals(true);
+		m_pWidget->ui->micVolumeSlider->blockSignals(true);
+		m_pWidget->ui->micMuteToggle->setChecked((pttEnabled && !pttActive) || micUserMute);
+		if (!m_pWidget->ui->micVolumeSlider->isSliderDown()) {
+			m_pWidget->ui->micVolumeSlider->setValue(micVolume);
 		}
+		m_pWidget->ui->micMuteToggle->blockSignals(false);
+		m_pWidget->ui->micVolumeSlider->blockSignals(false);
 	}
 }
 
 
 void OverlayController::pttEnableToggled(bool value) {
 	pttEnabled = value;
-	m_pWidget->ui->micMuteToggle->setChecked((pttEnabled && !pttActive) || micUserMute);
+	if (m_pPttInputThread) {
+		if (pttEnabled) {
+			// the mic gets muted below, push-to-talk starts from scratch
+			m_pPttInputThread->setActive(false);
+		} else {
+			// the input thread may still be in its last tick, it must be done with the mic before we restore the user's state
+			std::shared_future<bool> command = m_pPttInputThread->deactivate();
+			if (command.valid()) {
+				command.wait();
+			}
+			if (pttActive) {
+				vr::VROverlay()->HideOverlay(m_ulNotificationOverlayHandle);
+			}
+			logSpeculationStats();
+		}
+		pttActive = false;
+	}
+	publishPttConfig();
+	if (pttEnabled) {
+		m_pWidget->ui->micMuteToggle->setChecked(true);
+	} else {
+		// the toggle may already show the user's state while the mic is in push-to-talk's, so apply it either way
+		m_pWidget->ui->micMuteToggle->blockSignals(true);
+		m_pWidget->ui->micMuteToggle->setChecked(micUserMute);
+		m_pWidget->ui->micMuteToggle->blockSignals(false);
+		MicMuteToggled(micUserMute);
+	}
 	UpdateWidget();
 	appSettings.setValue("pttEnabled", value);
 }
@@ -576,12 +743,14 @@ void OverlayController::pttNotifyToggled(bool value) {
 
 void OverlayController::pttLeftControllerToggled(bool value) {
 	pttLeftControllerEnabled = value;
+	publishPttConfig();
 	appSettings.setValue("pttLeftControllerEnabled", value);
 }
 
 
 void OverlayController::pttRightControllerToggled(bool value) {
 	pttRightControllerEnabled = value;
+	publishPttConfig();
 	appSettings.setValue("pttRightControllerEnabled", value);
 }
 
@@ -592,6 +761,7 @@ void OverlayController::pttGripButtonToggled(bool value) {
 	} else {
 		pttDigitalButtonMask &= ~vr::ButtonMaskFromId(vr::k_EButton_Grip);
 	}
+	publishPttConfig();
 	appSettings.setValue("pttDigitalButtonMask", pttDigitalButtonMask);
 }
 
@@ -602,12 +772,14 @@ void OverlayController::pttMenuButtonToggled(bool value) {
 	} else {
 		pttDigitalButtonMask &= ~vr::ButtonMaskFromId(vr::k_EButton_ApplicationMenu);
 	}
+	publishPttConfig();
 	appSettings.setValue("pttDigitalButtonMask", pttDigitalButtonMask);
 }
 
 
 void OverlayController::pttTriggerButtonToggled(bool value) {
 	pttTriggerModus = value ? 1 : 0;
+	publishPttConfig();
 	appSettings.setValue("pttTriggerModus", pttTriggerModus);
 }
 
@@ -618,6 +790,7 @@ void OverlayController::pttPadTouchedToggled(bool value) {
 	} else {
 		pttPadModus &= ~1;
 	}
+	publishPttConfig();
 	appSettings.setValue("pttPadModus", pttPadModus);
 }
 
@@ -628,46 +801,55 @@ void OverlayController::pttPadPressedToggled(bool value) {
 	} else {
 		pttPadModus &= ~2;
 	}
+	publishPttConfig();
 	appSettings.setValue("pttPadModus", pttPadModus);
 }
 
 
 void OverlayController::pttPadAreaLeftToggled(bool value) {
 	if (value) {
-		pttPadArea |= PAD_AREA_LEFT;
+		pttPadArea |= PttInputConfig::PAD_AREA_LEFT;
 	} else {
-		pttPadArea &= ~PAD_AREA_LEFT;
+		pttPadArea &= ~PttInputConfig::PAD_AREA_LEFT;
 	}
+	updatePttPadSectors(PttInputConfig::PAD_AREA_LEFT, value);
+	publishPttConfig();
 	appSettings.setValue("pttPadArea", pttPadArea);
 }
 
 
 void OverlayController::pttPadAreaTopToggled(bool value) {
 	if (value) {
-		pttPadArea |= PAD_AREA_TOP;
+		pttPadArea |= PttInputConfig::PAD_AREA_TOP;
 	} else {
-		pttPadArea &= ~PAD_AREA_TOP;
+		pttPadArea &= ~PttInputConfig::PAD_AREA_TOP;
 	}
+	updatePttPadSectors(PttInputConfig::PAD_AREA_TOP, value);
+	publishPttConfig();
 	appSettings.setValue("pttPadArea", pttPadArea);
 }
 
 
 void OverlayController::pttPadAreaRightToggled(bool value) {
 	if (value) {
-		pttPadArea |= PAD_AREA_RIGHT;
+		pttPadArea |= PttInputConfig::PAD_AREA_RIGHT;
 	} else {
-		pttPadArea &= ~PAD_AREA_RIGHT;
+		pttPadArea &= ~PttInputConfig::PAD_AREA_RIGHT;
 	}
+	updatePttPadSectors(PttInputConfig::PAD_AREA_RIGHT, value);
+	publishPttConfig();
 	appSettings.setValue("pttPadArea", pttPadArea);
 }
 
 
 void OverlayController::pttPadAreaBottomToggled(bool value) {
 	if (value) {
-		pttPadArea |= PAD_AREA_BOTTOM;
+		pttPadArea |= PttInputConfig::PAD_AREA_BOTTOM;
 	} else {
-		pttPadArea &= ~PAD_AREA_BOTTOM;
+		pttPadArea &= ~PttInputConfig::PAD_AREA_BOTTOM;
 	}
+	updatePttPadSectors(PttInputConfig::PAD_AREA_BOTTOM, value);
+	publishPttConfig();
 	appSettings.setValue("pttPadArea", pttPadArea);
 }
 
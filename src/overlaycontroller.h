@@ -10,12 +10,13 @@
 #include <QVector2D>
 #include <QVector3D>
 #include <QSettings>
-#include <QtGui/QOpenGLContext>
 #include <QtWidgets/QGraphicsScene>
-#include <QOffscreenSurface>
-#include <QOpenGLFramebufferObject>
 #include <memory>
 #include "audiomanager.h"
+#include "audiocommandworker.h"
+#include "overlayrenderer.h"
+#include "framescheduler.h"
+#include "pttinputthread.h"
 #include "logging.h"
 
 
@@ -40,19 +41,23 @@ private:
 	vr::VROverlayHandle_t m_ulOverlayThumbnailHandle = vr::k_ulOverlayHandleInvalid;
 	vr::VROverlayHandle_t m_ulNotificationOverlayHandle = vr::k_ulOverlayHandleInvalid;
 
-	std::unique_ptr<QOpenGLContext> m_pOpenGLContext;
 	std::unique_ptr<QGraphicsScene> m_pScene;
-	std::unique_ptr<QOpenGLFramebufferObject> m_pFbo;
-	std::unique_ptr<QOffscreenSurface> m_pOffscreenSurface;
+	std::unique_ptr<OverlayRenderer> renderer;
+	std::unique_ptr<FrameScheduler> m_pFrameScheduler;
 
 	std::unique_ptr<QTimer> m_pPumpEventsTimer;
 	bool dashboardVisible = false;
 
 	QPointF m_ptLastMouse;
 	Qt::MouseButtons m_lastMouseButtons = 0;
+	QPointF m_ptPendingMouse;
+	bool mouseMovePending = false;
+	uint64_t mouseMovesReceived = 0;
+	uint64_t mouseMovesDispatched = 0;
 
 	bool micUserMute = false;
 	unsigned micVolume = 100;
+	unsigned micVolumeWriteInterval = 10; // ms
 
 	bool pttEnabled = false;
 	bool pttActive = false;
@@ -62,14 +67,25 @@ private:
 	uint64_t pttDigitalButtonMask = 0;
 	int pttTriggerModus = 0; // 0 .. disabled, 1 .. enabled
 	int pttPadModus = 0; // disabled, 1 .. only touch, 2 .. only press, 3 .. both
-	enum PadArea {
-		PAD_AREA_LEFT = (1 << 0),
-		PAD_AREA_TOP = (1 << 1),
-		PAD_AREA_RIGHT = (1 << 2),
-		PAD_AREA_BOTTOM = (1 << 3),
-	};
 	int pttPadArea = 0;
+	int pttPadSectorCount = 4;
+	uint32_t pttPadSectorMask = 0;
+	bool pttPadInnerArea = false;
+	float pttPadInnerRadius = 0.2f;
+	float pttPadSectorHysteresis = 5.0f;
+	float pttPadRadialHysteresis = 0.03f;
+	unsigned pttAttackDelay = 0; // ms
+	unsigned pttHoldTime = 0; // ms
+	bool pttSpeculativeUnmute = false;
+	unsigned pttSpeculationWindow = 200; // ms
+	float pttSpeculativeTriggerThreshold = 0.1f;
+	unsigned pttInputRate = 500; // Hz
+	QString pttLatencyDumpFile;
+	int pttInputMode = PttInputConfig::INPUT_MODE_POLLING;
+	unsigned pttEventIdleInterval = 10; // ms
+	std::unique_ptr<PttInputThread> m_pPttInputThread;
 	std::shared_ptr<AudioManager> audioManager;
+	std::shared_ptr<AudioCommandWorker> m_pAudioWorker;
 
 	QSettings appSettings;
 
@@ -77,7 +93,7 @@ public:
     OverlayController() : QObject(), appSettings("matzman666", "microphonecontrol") {}
 	virtual ~OverlayController();
 
-	void Init(std::shared_ptr<AudioManager> audioManager);
+	void Init(std::shared_ptr<AudioManager> audioManager, std::unique_ptr<OverlayRenderer> renderer);
 
 	bool isDashboardVisible() {
 		return dashboardVisible;
@@ -85,14 +101,42 @@ public:
 
 	void SetWidget(OverlayWidget *pWidget, const std::string& name, const std::string& key = "");
 
+	const LatencyTracer* getPttLatencyTracer() {
+		return m_pPttInputThread ? &m_pPttInputThread->getLatencyTracer() : nullptr;
+	}
+	bool dumpPttLatencies(const std::string& path);
+
+	void logRenderStats();
+	// renders the scene `frames` times with the given renderer and logs the frame times, needs neither OpenVR nor Init()
+	static void benchmarkRenderer(OverlayRenderer& renderer, QGraphicsScene& scene, const QSize& size, unsigned frames);
+
+	// thread-safe, called by the audio manager whenever the device state changed
+	void notifyAudioStateChanged(bool muted, float masterVolume) {
+		emit audioStateChanged(muted, masterVolume);
+	}
+
+signals:
+	void audioStateChanged(bool muted, float masterVolume);
+
+private:
+	bool renderScene();
+	void flushMouseMove();
+	PttInputConfig makePttConfig();
+	void publishPttConfig();
+	void logSpeculationStats();
+	void updatePttPadSectors(int area, bool value);
+	void savePttPadSectorMask();
+
 public slots:
 	void OnSceneChanged( const QList<QRectF>& );
 	void OnTimeoutPumpEvents();
 
 	void UpdateWidget();
+	void OnAudioStateChanged(bool muted, float masterVolume);
 
 	void MicMuteToggled(bool value);
 	void MicVolumeChanged(int value);
+	void MicVolumeReleased();
 
 	void pttEnableToggled(bool value);
 	void pttNotifyToggled(bool value);
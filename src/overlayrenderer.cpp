@@ -0,0 +1,136 @@
+#include "overlayrenderer.h"
+#include <QtWidgets/QAbstractButton>
+#include <QtWidgets/QAbstractSlider>
+#include <QtWidgets/QFrame>
+#include <QtWidgets/QGraphicsProxyWidget>
+#include <QtWidgets/QGraphicsScene>
+#include <QtWidgets/QGroupBox>
+#include <QtWidgets/QLabel>
+#include <cstring>
+
+
+// application namespace
+namespace miccontrol {
+
+namespace {
+
+// fast non-cryptographic hash, continues hash with length bytes
+uint64_t hashBytes(uint64_t hash, const void* data, size_t length) {
+	const uint64_t prime = 0x9e3779b97f4a7c15ull;
+	auto bytes = (const uchar*)data;
+	size_t i = 0;
+	for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t)) {
+		uint64_t word;
+		std::memcpy(&word, bytes + i, sizeof(word));
+		hash = (hash ^ word) * prime;
+		hash ^= hash >> 32;
+	}
+	for (; i < length; i++) {
+		hash = (hash ^ bytes[i]) * prime;
+	}
+	return hash;
+}
+
+template<typename T>
+uint64_t hashValue(uint64_t hash, const T& value) {
+	return hashBytes(hash, &value, sizeof(value));
+}
+
+uint64_t hashString(uint64_t hash, const QString& value) {
+	return hashBytes(hashValue(hash, value.size()), value.constData(), value.size() * sizeof(QChar));
+}
+
+// Everything a widget of the overlay paints depends on, returns false for widgets that paint more than that
+// (unknown types, the hovered part of a slider).
+bool hashWidget(uint64_t& hash, QWidget* widget, QWidget* top) {
+	hash = hashValue(hash, widget->metaObject());
+	hash = hashValue(hash, QRect(widget->mapTo(top, QPoint(0, 0)), widget->size()));
+	hash = hashValue(hash, widget->isVisibleTo(top));
+	if (!widget->isVisibleTo(top)) {
+		return true;
+	}
+	hash = hashValue(hash, widget->isEnabled());
+	hash = hashValue(hash, widget->hasFocus());
+	hash = hashValue(hash, widget->underMouse());
+	hash = hashValue(hash, widget->palette().cacheKey());
+	hash = hashString(hash, widget->styleSheet());
+	if (auto button = qobject_cast<QAbstractButton*>(widget)) {
+		hash = hashString(hash, button->text());
+		hash = hashValue(hash, button->icon().cacheKey());
+		hash = hashValue(hash, button->isChecked());
+		hash = hashValue(hash, button->isDown());
+	} else if (auto slider = qobject_cast<QAbstractSlider*>(widget)) {
+		hash = hashValue(hash, slider->minimum());
+		hash = hashValue(hash, slider->maximum());
+		hash = hashValue(hash, slider->sliderPosition());
+		hash = hashValue(hash, slider->isSliderDown());
+		// the style highlights whichever part is hovered, that depends on the mouse position
+		return !slider->underMouse();
+	} else if (auto groupBox = qobject_cast<QGroupBox*>(widget)) {
+		hash = hashString(hash, groupBox->title());
+		hash = hashValue(hash, groupBox->isCheckable());
+		hash = hashValue(hash, groupBox->isChecked());
+	} else if (auto label = qobject_cast<QLabel*>(widget)) {
+		hash = hashString(hash, label->text());
+		hash = hashValue(hash, label->pixmap() ? label->pixmap()->cacheKey() : 0);
+	} else if (widget != top && widget->metaObject() != &QWidget::staticMetaObject && widget->metaObject() != &QFrame::staticMetaObject) {
+		return false;
+	}
+	return true;
+}
+
+} // anonymous namespace
+
+
+void OverlayRenderer::renderFrame(QGraphicsScene& scene, vr::VROverlayHandle_t overlay) {
+	QRegion region = damage & QRect(QPoint(0, 0), size);
+	if (region.isEmpty()) {
+		return;
+	}
+	damage = QRegion();
+	if (region.rectCount() > maxDamageRects) {
+		region = region.boundingRect();
+	}
+	auto start = LatencyTracer::Clock::now();
+	QRegion repainted;
+	uint64_t state = 0;
+	bool stateComplete = skipUnchanged && overlay != vr::k_ulOverlayHandleInvalid && hashSceneState(scene, state);
+	if (stateComplete && submittedStateValid && state == submittedState) {
+		// the frame would look like the one the compositor shows, nothing to paint
+		suppressedFrames++;
+	} else {
+		repainted = render(scene, overlay, region);
+		submittedStateValid = stateComplete;
+		submittedState = state;
+	}
+	frameTimes.record(std::chrono::duration_cast<std::chrono::microseconds>(LatencyTracer::Clock::now() - start).count());
+	renderedFrames++;
+	// the rectangles of a QRegion never overlap
+	for (const QRect& rect : repainted.rects()) {
+		repaintedPixels += (uint64_t)rect.width() * rect.height();
+	}
+}
+
+
+// Walks the widgets instead of looking at pixels, that needs no painting (and on the GPU no read back) at all.
+bool OverlayRenderer::hashSceneState(QGraphicsScene& scene, uint64_t& hash) {
+	hash = 0;
+	bool complete = true;
+	for (QGraphicsItem* item : scene.items()) {
+		hash = hashValue(hash, item->isVisible());
+		hash = hashValue(hash, item->sceneBoundingRect());
+		auto proxy = qgraphicsitem_cast<QGraphicsProxyWidget*>(item);
+		if (!proxy || !proxy->widget()) {
+			complete = false;
+			continue;
+		}
+		QWidget* top = proxy->widget();
+		complete = hashWidget(hash, top, top) && complete;
+		for (QWidget* widget : top->findChildren<QWidget*>()) {
+			complete = hashWidget(hash, widget, top) && complete;
+		}
+	}
+	return complete;
+}
+
+} // namespace miccontrol
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <openvr.h>
+#include <QSize>
+#include <QRegion>
+#include <QRectF>
+#include "latencytracer.h"
+
+class QGraphicsScene;
+
+
+// application namespace
+namespace miccontrol {
+
+// Renders the overlay's scene and hands the result to the compositor.
+// Only the damaged parts of the scene are repainted, the rest of the render target is kept from the last frame.
+class OverlayRenderer {
+public:
+	// painting many small rectangles one by one costs more than the area they save
+	static constexpr int maxDamageRects = 8;
+
+protected:
+	QSize size;
+
+private:
+	bool skipUnchanged = false;
+	QRegion damage;
+	LatencyHistogram frameTimes; // us per renderFrame() call
+	uint64_t renderedFrames = 0;
+	uint64_t repaintedPixels = 0;
+	uint64_t suppressedFrames = 0;
+	bool submittedStateValid = false;
+	uint64_t submittedState = 0; // scene state hash of the frame the compositor shows
+
+public:
+	virtual ~OverlayRenderer() {}
+
+	// throws std::runtime_error when the renderer cannot work on this machine
+	virtual void init() = 0;
+	// (re)creates the render target, must be called before the first frame
+	virtual void setSize(const QSize& size) {
+		this->size = size;
+		submittedStateValid = false;
+		invalidate();
+	}
+	virtual const char* getName() const = 0;
+	// compares the state of the scene's widgets with that of the last submitted frame and neither renders nor submits
+	// frames that would look the same
+	void setSkipUnchanged(bool skip) {
+		skipUnchanged = skip;
+	}
+
+	// marks a scene rectangle to be repainted with the next frame
+	void addDamage(const QRectF& rect) {
+		damage += rect.toAlignedRect();
+	}
+	void invalidate() {
+		damage = QRect(QPoint(0, 0), size);
+	}
+	bool hasDamage() const {
+		return !(damage & QRect(QPoint(0, 0), size)).isEmpty();
+	}
+
+	// repaints the damaged region and submits the frame to the overlay, does nothing without damage;
+	// with vr::k_ulOverlayHandleInvalid the frame is rendered but not submitted (for benchmarks)
+	void renderFrame(QGraphicsScene& scene, vr::VROverlayHandle_t overlay);
+	// blocks until the last frame has really been rendered, only needed for benchmarks
+	virtual void finish() {}
+
+	const LatencyHistogram& getFrameTimes() const {
+		return frameTimes;
+	}
+	uint64_t getRenderedFrames() const {
+		return renderedFrames;
+	}
+	// repainted pixels relative to repainting every rendered frame in full
+	double getRepaintedFraction() const {
+		uint64_t framePixels = renderedFrames * size.width() * size.height();
+		return framePixels ? (double)repaintedPixels / framePixels : 0.0;
+	}
+	// frames that were neither rendered nor submitted because nothing changed
+	uint64_t getSuppressedFrames() const {
+		return suppressedFrames;
+	}
+	void resetStats() {
+		frameTimes.reset();
+		renderedFrames = 0;
+		repaintedPixels = 0;
+		suppressedFrames = 0;
+	}
+
+protected:
+	// region is in scene (= render target) coordinates and never empty,
+	// returns the region that was actually repainted (may be more than asked for)
+	virtual QRegion render(QGraphicsScene& scene, vr::VROverlayHandle_t overlay, const QRegion& region) = 0;
+
+private:
+	// returns false when the look of the scene depends on more than the hashed state
+	static bool hashSceneState(QGraphicsScene& scene, uint64_t& hash);
+};
+
+} // namespace miccontrol
@@ -0,0 +1,160 @@
+#include "overlayrenderergl.h"
+#include <QOpenGLFramebufferObjectFormat>
+#include <QOpenGLFunctions>
+#include <QOpenGLPaintDevice>
+#include <QPainter>
+#include <QtWidgets/QGraphicsScene>
+#include <stdexcept>
+#include "../logging.h"
+
+
+// application namespace
+namespace miccontrol {
+
+OverlayRendererGL::~OverlayRendererGL() {
+	if (context) {
+		context->makeCurrent(offscreenSurface.get());
+	}
+	for (auto& buffer : buffers) {
+		deleteFence(buffer);
+		buffer.fbo.reset();
+	}
+	offscreenSurface.reset();
+	context.reset();
+}
+
+
+void OverlayRendererGL::init() {
+	QSurfaceFormat format;
+	// Qt's QOpenGLPaintDevice is not compatible with OpenGL versions >= 3.0
+	// NVIDIA does not care, but unfortunately AMD does
+	// Are subtle changes to the semantics of OpenGL functions actually covered by the compatibility profile,
+	// and this is an AMD bug?
+	format.setVersion(2, 1);
+	//format.setProfile( QSurfaceFormat::CompatibilityProfile );
+	format.setDepthBufferSize(16);
+	format.setStencilBufferSize(8);
+	format.setSamples(16);
+
+	context.reset(new QOpenGLContext());
+	context->setFormat( format );
+	if (!context->create()) {
+		throw std::runtime_error("Could not create OpenGL context");
+	}
+
+	// create an offscreen surface to attach the context and FBO to
+	offscreenSurface.reset(new QOffscreenSurface());
+	offscreenSurface->setFormat(context->format());
+	offscreenSurface->create();
+	if (!context->makeCurrent( offscreenSurface.get() )) {
+		throw std::runtime_error("Could not make OpenGL context current");
+	}
+
+	// we ask for 2.1, but most drivers hand out a compatibility context that has sync objects anyway
+	hasFences = context->format().version() >= qMakePair(3, 2) || context->hasExtension("GL_ARB_sync");
+	if (!hasFences) {
+		LOG(INFO) << "OpenGL sync objects are not supported, falling back to glFlush.";
+	}
+}
+
+
+void OverlayRendererGL::setSize(const QSize& size) {
+	OverlayRenderer::setSize(size);
+	context->makeCurrent(offscreenSurface.get());
+
+	QOpenGLFramebufferObjectFormat fboFormat;
+	fboFormat.setAttachment(QOpenGLFramebufferObject::CombinedDepthStencil);
+	fboFormat.setTextureTarget(GL_TEXTURE_2D);
+
+	for (auto& buffer : buffers) {
+		deleteFence(buffer);
+		buffer.fbo.reset(new QOpenGLFramebufferObject(size, fboFormat));
+		buffer.stale = QRect(QPoint(0, 0), size);
+	}
+	currentBuffer = 0;
+}
+
+
+void OverlayRendererGL::finish() {
+	context->makeCurrent(offscreenSurface.get());
+	context->functions()->glFinish();
+}
+
+
+QRegion OverlayRendererGL::render(QGraphicsScene& scene, vr::VROverlayHandle_t overlay, const QRegion& region) {
+	context->makeCurrent(offscreenSurface.get());
+
+	unsigned index = (currentBuffer + 1) % fboCount;
+	Buffer& buffer = buffers[index];
+	waitForBuffer(buffer);
+
+	// the buffer also needs everything it missed while the other buffers were in use
+	QRegion repaint = region | buffer.stale;
+	if (repaint.rectCount() > maxDamageRects) {
+		repaint = repaint.boundingRect();
+	}
+	buffer.stale = QRegion();
+	for (unsigned i = 0; i < fboCount; i++) {
+		if (i != index) {
+			buffers[i].stale |= region;
+		}
+	}
+
+	buffer.fbo->bind();
+	{
+		QOpenGLPaintDevice device(buffer.fbo->size());
+		QPainter painter(&device);
+		painter.setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing | QPainter::SmoothPixmapTransform);
+		// QGraphicsScene::render() clips to the target rect (a scissor rect for the GL paint engine)
+		// and only exposes that part of the widget, the rest of the FBO keeps its last frame
+		for (const QRect& rect : repaint.rects()) {
+			scene.render(&painter, rect, rect);
+		}
+	}
+	buffer.fbo->release();
+
+	if (hasFences) {
+		buffer.fence = context->extraFunctions()->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		// a zero timeout wait with the flush bit flushes unless the frame is already complete,
+		// without a flush the compositor may see an empty texture
+		context->extraFunctions()->glClientWaitSync(buffer.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+	} else {
+		context->functions()->glFlush(); // We need to flush otherwise the texture may be empty.
+	}
+
+	GLuint unTexture = buffer.fbo->texture();
+	if (unTexture != 0 && overlay != vr::k_ulOverlayHandleInvalid) {
+#if defined _WIN64 || defined _LP64
+		// To avoid any compiler warning because of cast to a larger pointer type (warning C4312 on VC)
+		vr::Texture_t texture = { (void*)((uint64_t)unTexture), vr::API_OpenGL, vr::ColorSpace_Auto };
+#else
+		vr::Texture_t texture = { (void*)unTexture, vr::API_OpenGL, vr::ColorSpace_Auto };
+#endif
+		vr::VROverlay()->SetOverlayTexture(overlay, &texture);
+	}
+	currentBuffer = index;
+	return repaint;
+}
+
+
+void OverlayRendererGL::waitForBuffer(Buffer& buffer) {
+	if (!buffer.fence) {
+		return;
+	}
+	// with fboCount buffers the fence is several frames old and normally long signaled
+	GLenum result = context->extraFunctions()->glClientWaitSync(buffer.fence, GL_SYNC_FLUSH_COMMANDS_BIT, fenceTimeout);
+	if (result == GL_TIMEOUT_EXPIRED || result == GL_WAIT_FAILED) {
+		LOG(WARNING) << "Waiting for an overlay frame to complete failed, reusing its FBO anyway.";
+	}
+	deleteFence(buffer);
+}
+
+
+void OverlayRendererGL::deleteFence(Buffer& buffer) {
+	if (buffer.fence) {
+		context->extraFunctions()->glDeleteSync(buffer.fence);
+		buffer.fence = nullptr;
+	}
+}
+
+} // namespace miccontrol
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "../overlayrenderer.h"
+#include <memory>
+#include <QtGui/QOpenGLContext>
+#include <QOffscreenSurface>
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLExtraFunctions>
+
+
+// application namespace
+namespace miccontrol {
+
+// Paints the scene with QOpenGLPaintDevice into a ring of offscreen FBOs and submits their textures.
+// A frame never goes into the FBO that was submitted last, so the compositor can keep sampling it while we render.
+// GL fence syncs tell when an FBO's last frame is complete and the FBO may be reused.
+class OverlayRendererGL : public OverlayRenderer {
+public:
+	static constexpr unsigned fboCount = 3;
+	static constexpr uint64_t fenceTimeout = 100000000; // ns
+
+private:
+	struct Buffer {
+		std::unique_ptr<QOpenGLFramebufferObject> fbo;
+		GLsync fence = nullptr;
+		QRegion stale; // what was repainted in the other buffers since this one was last rendered
+	};
+
+	std::unique_ptr<QOpenGLContext> context;
+	std::unique_ptr<QOffscreenSurface> offscreenSurface;
+	bool hasFences = false;
+	Buffer buffers[fboCount];
+	unsigned currentBuffer = 0; // the one submitted last
+
+public:
+	~OverlayRendererGL();
+
+	void init() override;
+	void setSize(const QSize& size) override;
+	const char* getName() const override {
+		return "gl";
+	}
+	void finish() override;
+
+protected:
+	QRegion render(QGraphicsScene& scene, vr::VROverlayHandle_t overlay, const QRegion& region) override;
+
+private:
+	// blocks until the buffer's last frame is complete
+	void waitForBuffer(Buffer& buffer);
+	void deleteFence(Buffer& buffer);
+};
+
+} // namespace miccontrol
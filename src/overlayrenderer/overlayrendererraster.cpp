@@ -0,0 +1,35 @@
+#include "overlayrendererraster.h"
+#include <QPainter>
+#include <QtWidgets/QGraphicsScene>
+
+
+// application namespace
+namespace miccontrol {
+
+void OverlayRendererRaster::setSize(const QSize& size) {
+	OverlayRenderer::setSize(size);
+	// premultiplied is what the raster engine paints fastest into, the widget is opaque so the compositor
+	// gets the same colors as from straight alpha
+	image = QImage(size, QImage::Format_RGBA8888_Premultiplied);
+}
+
+
+QRegion OverlayRendererRaster::render(QGraphicsScene& scene, vr::VROverlayHandle_t overlay, const QRegion& region) {
+	{
+		QPainter painter(&image);
+		painter.setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing | QPainter::SmoothPixmapTransform);
+		for (const QRect& rect : region.rects()) {
+			painter.setCompositionMode(QPainter::CompositionMode_Source);
+			painter.fillRect(rect, Qt::transparent);
+			painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+			scene.render(&painter, rect, rect);
+		}
+	}
+	// SetOverlayRaw has no partial upload, but the runtime copies the pixels and the image can be reused right away
+	if (overlay != vr::k_ulOverlayHandleInvalid) {
+		vr::VROverlay()->SetOverlayRaw(overlay, image.bits(), image.width(), image.height(), 4);
+	}
+	return region;
+}
+
+} // namespace miccontrol
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "../overlayrenderer.h"
+#include <QImage>
+
+
+// application namespace
+namespace miccontrol {
+
+// Paints the scene with Qt's raster engine into a reused image and uploads it with SetOverlayRaw(),
+// for machines without a (usable) GPU.
+class OverlayRendererRaster : public OverlayRenderer {
+private:
+	QImage image;
+
+public:
+	void init() override {}
+	void setSize(const QSize& size) override;
+	const char* getName() const override {
+		return "raster";
+	}
+
+protected:
+	QRegion render(QGraphicsScene& scene, vr::VROverlayHandle_t overlay, const QRegion& region) override;
+};
+
+} // namespace miccontrol
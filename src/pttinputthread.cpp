@@ -0,0 +1,467 @@
+#include "pttinputthread.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include "logging.h"
+
+#ifdef _WIN32
+	#include <windows.h>
+#endif
+
+
+// application namespace
+namespace miccontrol {
+
+PttInputThread::PttInputThread(std::shared_ptr<AudioCommandWorker> audioWorker, unsigned inputRate)
+		: QThread(), audioWorker(audioWorker), inputRate(minInputRate), active(false), stopRequested(false), evaluationCount(0), skippedEvaluationCount(0),
+		speculationHitCount(0), speculationMissCount(0), pendingTransition(0), transitionGeneration(0) {
+	controllers[0].role = vr::TrackedControllerRole_LeftHand;
+	controllers[1].role = vr::TrackedControllerRole_RightHand;
+	setInputRate(inputRate);
+}
+
+
+PttInputThread::~PttInputThread() {
+	stop();
+	wait();
+}
+
+
+void PttInputThread::setConfig(const PttInputConfig& config) {
+	this->config.write(config);
+}
+
+
+void PttInputThread::setInputRate(unsigned rate) {
+	if (rate < minInputRate) {
+		rate = minInputRate;
+	} else if (rate > maxInputRate) {
+		rate = maxInputRate;
+	}
+	inputRate = rate;
+}
+
+
+void PttInputThread::stop() {
+	stopRequested = true;
+}
+
+
+void PttInputThread::setActive(bool value) {
+	std::lock_guard<std::mutex> lock(transitionMutex);
+	cancelPendingTransition();
+	active = value;
+	suspended = false;
+}
+
+
+std::shared_future<bool> PttInputThread::deactivate() {
+	std::lock_guard<std::mutex> lock(transitionMutex);
+	cancelPendingTransition();
+	active = false;
+	suspended = true;
+	return lastCommand;
+}
+
+
+// Must be called with transitionMutex held.
+void PttInputThread::cancelPendingTransition() {
+	if (pendingTransition) {
+		scheduler.cancel(pendingTransition);
+		pendingTransition = 0;
+	}
+	transitionGeneration++; // in case the timer is already firing
+}
+
+
+// Must be called with transitionMutex held.
+// The state is updated optimistically, the completion reverts it when the call failed so that the next tick retries.
+void PttInputThread::applyState(bool newState) {
+	uint64_t generation = ++transitionGeneration;
+	auto sampleTime = transitionSampleTime;
+	auto decisionTime = transitionDecisionTime;
+	active = newState;
+	lastCommand = audioWorker->setMuted(!newState, [this, newState, generation, sampleTime, decisionTime](bool success, AudioCommandWorker::Clock::time_point callTime) {
+		if (success) {
+			latencyTracer.record(newState ? LatencyTracer::TRANSITION_UNMUTE : LatencyTracer::TRANSITION_MUTE,
+					sampleTime, decisionTime, callTime, LatencyTracer::Clock::now());
+		} else if (generation == transitionGeneration) {
+			bool expected = newState;
+			active.compare_exchange_strong(expected, !newState);
+		}
+	});
+}
+
+
+void PttInputThread::updateState(unsigned inputState, LatencyTracer::Clock::time_point sampleTime, const PttInputConfig& config) {
+	bool pressed = inputState & INPUT_PTT;
+	bool imminent = !pressed && (inputState & INPUT_IMMINENT);
+	if (!imminent) {
+		speculationBlocked = false;
+	}
+	if (speculating) {
+		if (pressed) {
+			speculating = false;
+			speculationHitCount++;
+		} else if (!imminent || std::chrono::steady_clock::now() - speculationStart > std::chrono::milliseconds(config.speculationWindow)) {
+			// roll back right away, the hold time is meant for real presses
+			speculating = false;
+			speculationBlocked = imminent;
+			speculationMissCount++;
+			updateTransition(false, 0, sampleTime);
+			return;
+		} else {
+			return; // keep waiting for the press
+		}
+	} else if (imminent && !speculationBlocked && !active) {
+		speculating = true;
+		speculationStart = std::chrono::steady_clock::now();
+		// no attack delay, the point is to be unmuted before the press arrives
+		updateTransition(true, 0, sampleTime);
+		return;
+	}
+	updateTransition(pressed, pressed ? config.attackDelay : config.holdTime, sampleTime);
+}
+
+
+void PttInputThread::updateTransition(bool newState, unsigned delay, LatencyTracer::Clock::time_point sampleTime) {
+	if (newState == active && !pendingTransition) {
+		return; // nothing to do, don't bother with the lock
+	}
+	std::lock_guard<std::mutex> lock(transitionMutex);
+	if (suspended) {
+		return;
+	}
+	if (pendingTransition) {
+		if (pendingTransitionTarget == newState) {
+			return; // already on its way
+		}
+		cancelPendingTransition();
+	}
+	if (newState == active) {
+		return;
+	}
+	transitionSampleTime = sampleTime;
+	transitionDecisionTime = LatencyTracer::Clock::now();
+	if (delay == 0) {
+		applyState(newState);
+	} else {
+		uint64_t generation = ++transitionGeneration;
+		pendingTransitionTarget = newState;
+		pendingTransition = scheduler.schedule(std::chrono::milliseconds(delay), [this, newState, generation]() {
+			std::lock_guard<std::mutex> lock(transitionMutex);
+			if (generation == transitionGeneration) {
+				pendingTransition = 0;
+				applyState(newState);
+			}
+		});
+	}
+}
+
+
+unsigned PttInputThread::sampleController(ControllerInput& controller, const PttInputConfig& config) {
+	if (controller.deviceId != vr::k_unTrackedDeviceIndexInvalid) {
+		vr::VRControllerState_t state;
+		controller.sampleTime = LatencyTracer::Clock::now();
+		if (vr::VRSystem()->GetControllerState(controller.deviceId, &state)) {
+			recordSample(controller, state);
+			return evaluateSample(controller, state, config);
+		}
+	}
+	return 0;
+}
+
+
+// Idle controllers keep reporting the same packet, there is no need to evaluate it again.
+unsigned PttInputThread::evaluateSample(ControllerInput& controller, const vr::VRControllerState_t& state, const PttInputConfig& config) {
+	evaluationCount.fetch_add(1, std::memory_order_relaxed);
+	if (controller.lastResultValid && controller.lastPacketNum == state.unPacketNum) {
+		skippedEvaluationCount.fetch_add(1, std::memory_order_relaxed);
+		return controller.lastResult;
+	}
+	controller.lastResult = 0;
+	if (config.predicate.evaluate(state, controller.padSector)) {
+		controller.lastResult |= INPUT_PTT;
+	}
+	if (config.predicate.isImminent(state)) {
+		controller.lastResult |= INPUT_IMMINENT;
+	}
+	controller.lastPacketNum = state.unPacketNum;
+	controller.lastResultValid = true;
+	return controller.lastResult;
+}
+
+
+void PttInputThread::invalidateSamples() {
+	for (auto& controller : controllers) {
+		controller.lastResultValid = false;
+	}
+}
+
+
+unsigned PttInputThread::evaluateButtonEvents(ControllerInput& controller, const PttInputConfig& config) {
+	if (controller.deviceId == vr::k_unTrackedDeviceIndexInvalid) {
+		return 0;
+	}
+	vr::VRControllerState_t state = {};
+	state.ulButtonPressed = controller.buttonPressed;
+	state.ulButtonTouched = controller.buttonTouched;
+	// button events carry no axis data, so only the touchpad area decision needs a real sample
+	if (config.predicate.needsPadAxis(state.ulButtonPressed, state.ulButtonTouched)) {
+		controller.sampleTime = LatencyTracer::Clock::now();
+		if (!vr::VRSystem()->GetControllerState(controller.deviceId, &state)) {
+			return 0;
+		}
+		recordSample(controller, state);
+		return evaluateSample(controller, state, config);
+	}
+	recordSample(controller, state);
+	unsigned result = config.predicate.evaluate(state, controller.padSector) ? INPUT_PTT : 0;
+	if (config.predicate.isImminent(state)) {
+		result |= INPUT_IMMINENT;
+	}
+	return result;
+}
+
+
+// Resolving a role is an IPC round-trip into vrserver, so we only do it when OpenVR tells us that roles may have changed.
+void PttInputThread::refreshDeviceIds() {
+	for (auto& controller : controllers) {
+		controller.deviceId = vr::VRSystem()->GetTrackedDeviceIndexForControllerRole(controller.role);
+	}
+}
+
+
+void PttInputThread::resyncButtonStates() {
+	for (auto& controller : controllers) {
+		vr::VRControllerState_t state;
+		if (controller.deviceId != vr::k_unTrackedDeviceIndexInvalid && vr::VRSystem()->GetControllerState(controller.deviceId, &state)) {
+			controller.buttonPressed = state.ulButtonPressed;
+			controller.buttonTouched = state.ulButtonTouched;
+		} else {
+			controller.buttonPressed = 0;
+			controller.buttonTouched = 0;
+		}
+	}
+}
+
+
+// Nobody else reads the system events, they must not pile up into a stale burst while we don't need them.
+void PttInputThread::discardSystemEvents() {
+	if (!vr::VRSystem()) {
+		return;
+	}
+	vr::VREvent_t vrEvent;
+	while (vr::VRSystem()->PollNextEvent(&vrEvent, sizeof(vrEvent))) {
+	}
+}
+
+
+void PttInputThread::handleButtonEvent(const vr::VREvent_t& event) {
+	for (auto& controller : controllers) {
+		if (controller.deviceId != event.trackedDeviceIndex) {
+			continue;
+		}
+		auto buttonMask = vr::ButtonMaskFromId((vr::EVRButtonId)event.data.controller.button);
+		controller.sampleTime = LatencyTracer::Clock::now() - std::chrono::duration_cast<LatencyTracer::Clock::duration>(std::chrono::duration<float>(event.eventAgeSeconds));
+		switch (event.eventType) {
+			case vr::VREvent_ButtonPress:
+				controller.buttonPressed |= buttonMask;
+				break;
+			case vr::VREvent_ButtonUnpress:
+				controller.buttonPressed &= ~buttonMask;
+				break;
+			case vr::VREvent_ButtonTouch:
+				controller.buttonTouched |= buttonMask;
+				break;
+			case vr::VREvent_ButtonUntouch:
+				controller.buttonTouched &= ~buttonMask;
+				break;
+		}
+	}
+}
+
+
+void PttInputThread::recordSample(const ControllerInput& controller, const vr::VRControllerState_t& state) {
+	if (recorder) {
+		recorder->record(&controller == &controllers[0] ? 0 : 1, controller.deviceId, controller.sampleTime, state);
+	}
+}
+
+
+// Feeds the recorded states through the same evaluation as live samples, with the recording's timing.
+void PttInputThread::replaySamples(const PttInputConfig& config) {
+	if (!replayStarted) {
+		LOG(INFO) << "Replaying controller input.";
+		replayStarted = true;
+		replayStart = LatencyTracer::Clock::now();
+		invalidateSamples();
+	}
+	replayer->advance(std::chrono::duration_cast<std::chrono::nanoseconds>(LatencyTracer::Clock::now() - replayStart).count());
+	if (replayer->isFinished() && !replayFinished) {
+		replayFinished = true;
+		LOG(INFO) << "Controller input replay finished, keeping the last recorded states.";
+	}
+
+	unsigned newState = 0;
+	LatencyTracer::Clock::time_point sampleTime;
+	bool controllerEnabled[] = { config.leftControllerEnabled, config.rightControllerEnabled };
+	for (int i = 0; i < 2; i++) {
+		const InputSample* sample = replayer->getCurrent(i);
+		if (!controllerEnabled[i] || !sample) {
+			continue;
+		}
+		if (sample != replayedSamples[i]) {
+			replayedSamples[i] = sample;
+			controllers[i].sampleTime = replayStart + std::chrono::duration_cast<LatencyTracer::Clock::duration>(std::chrono::nanoseconds(sample->time));
+			if (sample->state.unPacketNum == 0) {
+				controllers[i].lastResultValid = false; // assembled from button events, no packet number to go by
+			}
+		}
+		newState |= updateControllerState(controllers[i], evaluateSample(controllers[i], sample->state, config));
+		if (controllers[i].changeTime > sampleTime) {
+			sampleTime = controllers[i].changeTime;
+		}
+	}
+	updateState(newState, sampleTime, config);
+}
+
+
+unsigned PttInputThread::updateControllerState(ControllerInput& controller, unsigned inputState) {
+	if (inputState != controller.inputState) {
+		controller.inputState = inputState;
+		controller.changeTime = controller.sampleTime;
+	}
+	return inputState;
+}
+
+
+void PttInputThread::run() {
+#ifdef _WIN32
+	// default scheduler granularity on windows is ~15ms, which is way too coarse for our input rates
+	timeBeginPeriod(1);
+#endif
+	LOG(INFO) << "Push-to-talk input thread started with " << inputRate << " Hz.";
+
+	auto nextTick = std::chrono::steady_clock::now();
+	std::chrono::microseconds idleInterval(0);
+	bool wasEnabled = false;
+	while (!stopRequested) {
+		bool idle = false;
+		bool configChanged = config.update();
+		const PttInputConfig& currentConfig = config.read();
+		bool reenabled = currentConfig.enabled && !wasEnabled;
+		wasEnabled = currentConfig.enabled;
+		if (!currentConfig.enabled) {
+			speculating = false;
+			if (pendingTransition || active) {
+				// the GUI restores the user's mic state, a transition applied meanwhile is not ours to keep
+				std::lock_guard<std::mutex> lock(transitionMutex);
+				cancelPendingTransition();
+				active = false;
+			}
+			discardSystemEvents();
+		} else if (replayer) {
+			discardSystemEvents();
+			replaySamples(currentConfig);
+		} else if (vr::VRSystem()) {
+			bool eventMode = currentConfig.inputMode == PttInputConfig::INPUT_MODE_EVENTS;
+			if (reenabled) {
+				// the discarded events may have changed roles
+				refreshDeviceIds();
+			}
+			if (configChanged || reenabled) {
+				invalidateSamples();
+			}
+			bool buttonEvents = false;
+			vr::VREvent_t vrEvent;
+			while (vr::VRSystem()->PollNextEvent(&vrEvent, sizeof(vrEvent))) {
+				switch (vrEvent.eventType) {
+					case vr::VREvent_TrackedDeviceRoleChanged:
+					case vr::VREvent_TrackedDeviceActivated:
+					case vr::VREvent_TrackedDeviceDeactivated:
+						refreshDeviceIds();
+						invalidateSamples();
+						if (eventMode) {
+							resyncButtonStates();
+						}
+						break;
+					case vr::VREvent_ButtonPress:
+					case vr::VREvent_ButtonUnpress:
+					case vr::VREvent_ButtonTouch:
+					case vr::VREvent_ButtonUntouch:
+						if (eventMode) {
+							handleButtonEvent(vrEvent);
+							buttonEvents = true;
+						}
+						break;
+				}
+			}
+			if (eventMode && (reenabled || configChanged)) {
+				// button events were discarded while push-to-talk was off, or event mode was just switched on
+				resyncButtonStates();
+			}
+
+			// in event mode nothing can change without an event unless the touchpad area is checked or a speculation runs out
+			idle = eventMode && !buttonEvents && !reenabled && !configChanged;
+			unsigned newState = 0;
+			LatencyTracer::Clock::time_point sampleTime;
+			bool controllerEnabled[] = { currentConfig.leftControllerEnabled, currentConfig.rightControllerEnabled };
+			for (int i = 0; i < 2; i++) {
+				if (controllerEnabled[i]) {
+					if (eventMode && currentConfig.predicate.needsPadAxis(controllers[i].buttonPressed, controllers[i].buttonTouched)) {
+						idle = false;
+					}
+					newState |= updateControllerState(controllers[i], eventMode ? evaluateButtonEvents(controllers[i], currentConfig) : sampleController(controllers[i], currentConfig));
+					// the most recent change is the one that causes a transition
+					if (controllers[i].changeTime > sampleTime) {
+						sampleTime = controllers[i].changeTime;
+					}
+				}
+			}
+
+			updateState(newState, sampleTime, currentConfig);
+			if (speculating) {
+				idle = false;
+			}
+		}
+
+		std::chrono::microseconds interval(1000000 / inputRate);
+		if (idle) {
+			// back off while idle, the first button event brings back the input rate
+			idleInterval = std::min(std::max(idleInterval * 2, interval), std::chrono::microseconds(currentConfig.eventIdleInterval * 1000));
+			interval = std::max(interval, idleInterval);
+		} else {
+			idleInterval = std::chrono::microseconds(0);
+		}
+		nextTick += interval;
+		auto now = std::chrono::steady_clock::now();
+		if (nextTick < now) {
+			nextTick = now; // we fell behind, don't try to catch up with a burst of samples
+		}
+		std::this_thread::sleep_until(nextTick);
+	}
+
+	std::shared_future<bool> command;
+	{
+		std::lock_guard<std::mutex> lock(transitionMutex);
+		cancelPendingTransition();
+		command = lastCommand;
+	}
+	if (command.valid()) {
+		command.wait(); // its completion refers to us
+	}
+	if (recorder) {
+		recorder->close();
+	}
+	LOG(INFO) << "Push-to-talk input thread stopped, skipped " << skippedEvaluationCount << " of " << evaluationCount << " controller state evaluations.";
+	if (speculationHitCount || speculationMissCount) {
+		LOG(INFO) << "Speculative unmutes: " << speculationHitCount << " hits, " << speculationMissCount << " misses.";
+	}
+	LOG(INFO) << "Push-to-talk latencies:\n" << latencyTracer.summary();
+#ifdef _WIN32
+	timeEndPeriod(1);
+#endif
+}
+
+} // namespace miccontrol
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <openvr.h>
+#include <QThread>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include "audiocommandworker.h"
+#include "deadlinescheduler.h"
+#include "inputrecording.h"
+#include "latencytracer.h"
+#include "pttpredicate.h"
+#include "triplebuffer.h"
+
+
+// application namespace
+namespace miccontrol {
+
+struct PttInputConfig {
+	enum InputMode {
+		INPUT_MODE_POLLING = 0, // sample the controller state at the input rate
+		INPUT_MODE_EVENTS = 1, // track button events, sample only when the touchpad area matters
+	};
+	enum PadArea {
+		PAD_AREA_LEFT = (1 << 0),
+		PAD_AREA_TOP = (1 << 1),
+		PAD_AREA_RIGHT = (1 << 2),
+		PAD_AREA_BOTTOM = (1 << 3),
+		PAD_AREA_ALL = PAD_AREA_LEFT | PAD_AREA_TOP | PAD_AREA_RIGHT | PAD_AREA_BOTTOM,
+	};
+
+	bool enabled = false;
+	int inputMode = INPUT_MODE_POLLING;
+	unsigned eventIdleInterval = 10; // ms, longest tick in event mode while no button changes and no touchpad area is checked
+	bool leftControllerEnabled = false;
+	bool rightControllerEnabled = false;
+	uint64_t digitalButtonMask = 0;
+	int triggerModus = 0; // 0 .. disabled, 1 .. enabled
+	int padModus = 0; // disabled, 1 .. only touch, 2 .. only press, 3 .. both
+	int padArea = 0;
+	int padSectorCount = 4;
+	uint32_t padSectorMask = 0; // bit n .. sector n, see PttPredicate
+	bool padInnerArea = false;
+	float padInnerRadius = 0.2f;
+	float padSectorHysteresis = 5.0f; // degrees
+	float padRadialHysteresis = 0.03f;
+	unsigned attackDelay = 0; // ms between pressing the button and unmuting
+	unsigned holdTime = 0; // ms between releasing the button and muting
+	bool speculativeUnmute = false; // unmute when a press is imminent, mute again if it does not follow
+	unsigned speculationWindow = 200; // ms a speculative unmute may last without a press
+	float speculativeTriggerThreshold = 0.1f;
+
+	PttPredicate predicate; // compiled from the fields above, see PttPredicate::compile()
+};
+
+
+// Samples the controllers at a fixed rate independent of the Qt event loop and mutes/unmutes the microphone.
+// The GUI thread hands over the configuration and reads back the push-to-talk state without any locking.
+class PttInputThread : public QThread {
+public:
+	static constexpr unsigned minInputRate = 50;
+	static constexpr unsigned maxInputRate = 2000;
+
+private:
+	enum InputState {
+		INPUT_PTT = (1 << 0), // push-to-talk is pressed
+		INPUT_IMMINENT = (1 << 1), // push-to-talk press is likely about to happen
+	};
+
+	struct ControllerInput {
+		vr::ETrackedControllerRole role;
+		vr::TrackedDeviceIndex_t deviceId = vr::k_unTrackedDeviceIndexInvalid; // cached, see refreshDeviceIds()
+		uint64_t buttonPressed = 0; // only maintained in event mode
+		uint64_t buttonTouched = 0; // only maintained in event mode
+		bool lastResultValid = false;
+		unsigned lastResult = 0;
+		uint32_t lastPacketNum = 0;
+		uint8_t padSector = PttPredicate::padSectorNone;
+		unsigned inputState = 0;
+		LatencyTracer::Clock::time_point sampleTime; // when the current button state was observed
+		LatencyTracer::Clock::time_point changeTime; // sampleTime of the last change of inputState
+	};
+
+	std::shared_ptr<AudioCommandWorker> audioWorker;
+	TripleBuffer<PttInputConfig> config;
+	ControllerInput controllers[2];
+	std::atomic<unsigned> inputRate;
+	std::atomic<bool> active;
+	std::atomic<bool> stopRequested;
+	std::atomic<uint64_t> evaluationCount;
+	std::atomic<uint64_t> skippedEvaluationCount;
+
+	// speculative unmuting, only touched by the input thread except for the counters
+	bool speculating = false;
+	bool speculationBlocked = false; // after a miss, until the imminent state goes away
+	std::chrono::steady_clock::time_point speculationStart;
+	std::atomic<uint64_t> speculationHitCount;
+	std::atomic<uint64_t> speculationMissCount;
+
+	// delayed mute/unmute, guarded by transitionMutex
+	std::mutex transitionMutex;
+	std::atomic<DeadlineScheduler::TimerId> pendingTransition;
+	bool pendingTransitionTarget = false;
+	bool suspended = false; // set by deactivate(), no transitions until setActive() is called again
+	std::atomic<uint64_t> transitionGeneration;
+	std::shared_future<bool> lastCommand;
+	LatencyTracer::Clock::time_point transitionSampleTime;
+	LatencyTracer::Clock::time_point transitionDecisionTime;
+	LatencyTracer latencyTracer;
+
+	// controller input recording and replay, only touched by the input thread once it runs
+	std::unique_ptr<InputRecorder> recorder;
+	std::unique_ptr<InputReplayer> replayer;
+	bool replayStarted = false;
+	bool replayFinished = false;
+	LatencyTracer::Clock::time_point replayStart;
+	const InputSample* replayedSamples[2] = { nullptr, nullptr };
+
+	DeadlineScheduler scheduler; // keep last, its thread must be gone before the members above are destroyed
+
+public:
+	PttInputThread(std::shared_ptr<AudioCommandWorker> audioWorker, unsigned inputRate);
+	virtual ~PttInputThread();
+
+	// must only be called from one thread (usually the GUI thread)
+	void setConfig(const PttInputConfig& config);
+
+	void setInputRate(unsigned rate);
+	unsigned getInputRate() {
+		return inputRate;
+	}
+
+	bool isActive() {
+		return active;
+	}
+	void setActive(bool value);
+	// Stops applying transitions right away (even from a tick that is still running) and resets the state to inactive.
+	// Returns the last mute/unmute command, the caller has to wait for it before setting the mic state itself.
+	std::shared_future<bool> deactivate();
+
+	void stop();
+
+	// both must be called before start(), a replay takes the place of the OpenVR controller input
+	void setRecorder(std::unique_ptr<InputRecorder> recorder) {
+		this->recorder = std::move(recorder);
+	}
+	void setReplayer(std::unique_ptr<InputReplayer> replayer) {
+		this->replayer = std::move(replayer);
+	}
+
+	// number of sampled controller states, and how many of them were skipped because the packet number did not change
+	uint64_t getEvaluationCount() {
+		return evaluationCount;
+	}
+	uint64_t getSkippedEvaluationCount() {
+		return skippedEvaluationCount;
+	}
+
+	// speculative unmutes that were followed by a real press (hit) or rolled back (miss)
+	uint64_t getSpeculationHitCount() {
+		return speculationHitCount;
+	}
+	uint64_t getSpeculationMissCount() {
+		return speculationMissCount;
+	}
+
+	const LatencyTracer& getLatencyTracer() const {
+		return latencyTracer;
+	}
+	void resetLatencyTracer() {
+		latencyTracer.reset();
+	}
+
+protected:
+	void run() override;
+
+private:
+	unsigned sampleController(ControllerInput& controller, const PttInputConfig& config);
+	unsigned evaluateSample(ControllerInput& controller, const vr::VRControllerState_t& state, const PttInputConfig& config);
+	void invalidateSamples();
+	unsigned evaluateButtonEvents(ControllerInput& controller, const PttInputConfig& config);
+	void refreshDeviceIds();
+	void resyncButtonStates();
+	void handleButtonEvent(const vr::VREvent_t& event);
+	void discardSystemEvents();
+	void recordSample(const ControllerInput& controller, const vr::VRControllerState_t& state);
+	void replaySamples(const PttInputConfig& config);
+	unsigned updateControllerState(ControllerInput& controller, unsigned inputState);
+	void updateState(unsigned inputState, LatencyTracer::Clock::time_point sampleTime, const PttInputConfig& config);
+	void updateTransition(bool newState, unsigned delay, LatencyTracer::Clock::time_point sampleTime);
+	void applyState(bool newState);
+	void cancelPendingTransition();
+};
+
+} // namespace miccontrol
@@ -0,0 +1,129 @@
+#include "pttpredicate.h"
+#include "pttinputthread.h"
+#include <algorithm>
+#include <cmath>
+
+
+// application namespace
+namespace miccontrol {
+
+static const double pi = 3.14159265358979323846;
+
+// angle in degrees, measured clockwise from the left edge of the touchpad, in [0, 360)
+static double padAngle(double x, double y) {
+	double angle = std::atan2(y, -x) * 180.0 / pi;
+	return angle < 0.0 ? angle + 360.0 : angle;
+}
+
+
+void PttPredicate::compile(const PttInputConfig& config) {
+	const uint64_t triggerMask = vr::ButtonMaskFromId(vr::k_EButton_SteamVR_Trigger);
+	const uint64_t padMask = vr::ButtonMaskFromId(vr::k_EButton_SteamVR_Touchpad);
+
+	unsigned sectorCount = config.padSectorCount;
+	if (sectorCount < 1) {
+		sectorCount = 1;
+	} else if (sectorCount > maxPadSectors) {
+		sectorCount = maxPadSectors;
+	}
+	uint32_t allSectors = (uint32_t)(((uint64_t)1 << (sectorCount + 1)) - 1);
+	activeSectors = ((config.padSectorMask << 1) | (config.padInnerArea ? 1 : 0)) & allSectors;
+
+	pressedMask = config.digitalButtonMask;
+	touchedMask = 0;
+	padPressedMask = 0;
+	padTouchedMask = 0;
+	if (config.triggerModus) {
+		pressedMask |= triggerMask;
+		// with speculative unmuting touching or slightly pulling the trigger only announces a press, see isImminent()
+		if (!config.speculativeUnmute) {
+			touchedMask |= triggerMask;
+		}
+	}
+	if (activeSectors == allSectors) {
+		// the whole touchpad counts, no need to look at the axis
+		if (config.padModus & 1) {
+			touchedMask |= padMask;
+		}
+		if (config.padModus & 2) {
+			pressedMask |= padMask;
+		}
+	} else if (activeSectors) {
+		if (config.padModus & 1) {
+			padTouchedMask = padMask;
+		}
+		if (config.padModus & 2) {
+			padPressedMask = padMask;
+		}
+	}
+
+	imminentTouchedMask = 0;
+	imminentPadTouchedMask = 0;
+	imminentTriggerThreshold = 2.0f;
+	if (config.speculativeUnmute) {
+		// touching something that only counts when pressed means the press is likely to follow
+		imminentTouchedMask = pressedMask & ~touchedMask;
+		imminentPadTouchedMask = padPressedMask & ~padTouchedMask;
+		if (config.triggerModus) {
+			imminentTriggerThreshold = config.speculativeTriggerThreshold;
+		}
+	}
+
+	// classify the center of each grid cell
+	double sectorWidth = 360.0 / sectorCount;
+	double angleBand = config.padSectorHysteresis;
+	double radiusBand = config.padRadialHysteresis;
+	for (unsigned row = 0; row < padGridSize; row++) {
+		double y = ((double)row + 0.5) / (padGridSize / 2) - 1.0;
+		for (unsigned column = 0; column < padGridSize; column++) {
+			double x = ((double)column + 0.5) / (padGridSize / 2) - 1.0;
+			// with four sectors the inner area is the square deadzone of the original four-area layout, otherwise a circle
+			double radius = sectorCount == 4 ? std::max(std::abs(x), std::abs(y)) : std::sqrt(x * x + y * y);
+			// shift by half a sector so that sector 0 is centered on the left edge
+			double angle = std::fmod(padAngle(x, y) + sectorWidth / 2.0, 360.0);
+			unsigned outerSector = (unsigned)(angle / sectorWidth) % sectorCount + 1;
+
+			PadCell& cell = padTable[row][column];
+			cell.sector = radius < config.padInnerRadius ? padSectorInner : outerSector;
+			cell.alternative = cell.sector;
+			if (std::abs(radius - config.padInnerRadius) < radiusBand) {
+				cell.alternative = cell.sector == padSectorInner ? outerSector : padSectorInner;
+			} else if (cell.sector != padSectorInner && sectorCount > 1) {
+				double offset = std::fmod(angle, sectorWidth);
+				if (offset < angleBand) {
+					cell.alternative = (outerSector + sectorCount - 2) % sectorCount + 1;
+				} else if (sectorWidth - offset < angleBand) {
+					cell.alternative = outerSector % sectorCount + 1;
+				}
+			}
+		}
+	}
+}
+
+
+uint32_t PttPredicate::sectorMaskFromPadArea(int padArea, unsigned sectorCount) {
+	static const int areas[] = {
+		PttInputConfig::PAD_AREA_LEFT,
+		PttInputConfig::PAD_AREA_TOP,
+		PttInputConfig::PAD_AREA_RIGHT,
+		PttInputConfig::PAD_AREA_BOTTOM
+	};
+	if (sectorCount < 1 || sectorCount > maxPadSectors) {
+		return 0;
+	}
+	uint32_t mask = 0;
+	double sectorWidth = 360.0 / sectorCount;
+	for (unsigned sector = 0; sector < sectorCount; sector++) {
+		double center = sector * sectorWidth;
+		for (unsigned quadrant = 0; quadrant < 4; quadrant++) {
+			// distance between the sector center and the quadrant center (left = 0, top = 90, ...)
+			double distance = std::abs(std::fmod(center - quadrant * 90.0 + 540.0, 360.0) - 180.0);
+			if ((padArea & areas[quadrant]) && distance <= 45.0 + 1e-6) {
+				mask |= (uint32_t)1 << sector;
+			}
+		}
+	}
+	return mask;
+}
+
+} // namespace miccontrol
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <openvr.h>
+#include <cstdint>
+
+
+// application namespace
+namespace miccontrol {
+
+struct PttInputConfig;
+
+// Push-to-talk bindings compiled into plain bit masks and a touchpad lookup table, so that evaluating a
+// controller state needs no branching on the configuration and no trigonometry.
+//
+// The touchpad is split into an inner ring and N sectors around it. Sector 0 is centered on the left
+// edge, the following sectors continue clockwise (for N = 4: left, top, right, bottom). For N = 4 the
+// inner area is a square like the deadzone of the original four-area layout, for any other N a circle.
+class PttPredicate {
+public:
+	static constexpr unsigned padGridSize = 64; // touchpad lookup table resolution per axis
+	static constexpr unsigned maxPadSectors = 31;
+	static constexpr uint8_t padSectorInner = 0; // sector ids in the lookup table are shifted by one
+	static constexpr uint8_t padSectorNone = 0xFF;
+
+private:
+	struct PadCell {
+		uint8_t sector; // sector the cell belongs to
+		uint8_t alternative; // sector on the other side of a boundary when the cell lies within the hysteresis band, otherwise == sector
+	};
+
+	uint64_t pressedMask = 0; // any of these buttons pressed -> push-to-talk
+	uint64_t touchedMask = 0; // any of these buttons touched -> push-to-talk
+	uint64_t padPressedMask = 0; // touchpad pressed -> push-to-talk depending on the touched sector
+	uint64_t padTouchedMask = 0; // touchpad touched -> push-to-talk depending on the touched sector
+	uint32_t activeSectors = 0; // bit 0 .. inner ring, bit n .. sector n - 1
+	uint64_t imminentTouchedMask = 0; // buttons bound to presses that are already touched -> press is imminent
+	uint64_t imminentPadTouchedMask = 0; // same for the touchpad, depending on the touched sector
+	float imminentTriggerThreshold = 2.0f; // analog trigger value at which a press is imminent, > 1 .. disabled
+	PadCell padTable[padGridSize][padGridSize] = {}; // [quantized y][quantized x]
+
+public:
+	void compile(const PttInputConfig& config);
+
+	// padSector holds per controller state between calls and should be initialized with padSectorNone
+	bool evaluate(const vr::VRControllerState_t& state, uint8_t& padSector) const {
+		if ((state.ulButtonPressed & pressedMask) | (state.ulButtonTouched & touchedMask)) {
+			return true;
+		}
+		if ((state.ulButtonPressed & padPressedMask) | (state.ulButtonTouched & padTouchedMask)) {
+			const PadCell& cell = padTable[quantize(state.rAxis[0].y)][quantize(state.rAxis[0].x)];
+			// within the hysteresis band we stick to the sector we came from
+			padSector = padSector == cell.alternative ? cell.alternative : cell.sector;
+			return (activeSectors >> padSector) & 1;
+		}
+		padSector = padSectorNone;
+		return false;
+	}
+
+	// true when a push-to-talk press is likely about to happen (only with speculative unmuting enabled)
+	bool isImminent(const vr::VRControllerState_t& state) const {
+		if ((state.ulButtonTouched & imminentTouchedMask) || state.rAxis[1].x >= imminentTriggerThreshold) {
+			return true;
+		}
+		if (state.ulButtonTouched & imminentPadTouchedMask) {
+			const PadCell& cell = padTable[quantize(state.rAxis[0].y)][quantize(state.rAxis[0].x)];
+			return (activeSectors >> cell.sector) & 1;
+		}
+		return false;
+	}
+
+	// true when the result depends on the touchpad axis, i.e. the button masks alone are not sufficient
+	bool needsPadAxis(uint64_t buttonPressed, uint64_t buttonTouched) const {
+		return ((buttonPressed & padPressedMask) | (buttonTouched & (padTouchedMask | imminentPadTouchedMask))) != 0;
+	}
+
+	static unsigned quantize(float value) {
+		int index = (int)((value + 1.0f) * (padGridSize / 2));
+		return index < 0 ? 0 : (index >= (int)padGridSize ? padGridSize - 1 : index);
+	}
+
+	// all sectors whose center lies within the given PttInputConfig::PadArea quadrants (diagonal sectors count for both neighbours)
+	static uint32_t sectorMaskFromPadArea(int padArea, unsigned sectorCount);
+};
+
+} // namespace miccontrol
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+
+// application namespace
+namespace miccontrol {
+
+// Lock-free handoff of the latest value from exactly one producer thread to exactly one consumer thread.
+// The producer never waits for the consumer and vice versa, older values that have not been picked up
+// by the consumer are simply overwritten.
+template<typename T>
+class TripleBuffer {
+private:
+	static constexpr uint8_t indexMask = 0x3;
+	static constexpr uint8_t dirtyBit = 0x4;
+
+	T buffers[3];
+	std::atomic<uint8_t> middle; // index of the shared buffer, dirtyBit is set when it holds an unread value
+	uint8_t back = 0; // owned by the producer
+	uint8_t front = 1; // owned by the consumer
+
+public:
+	TripleBuffer() : middle(2) {}
+	explicit TripleBuffer(const T& value) : middle(2) {
+		buffers[0] = buffers[1] = buffers[2] = value;
+	}
+
+	// producer side
+	void write(const T& value) {
+		buffers[back] = value;
+		back = middle.exchange(back | dirtyBit, std::memory_order_acq_rel) & indexMask;
+	}
+
+	// consumer side, returns true when a new value has been picked up
+	bool update() {
+		if (!(middle.load(std::memory_order_relaxed) & dirtyBit)) {
+			return false;
+		}
+		front = middle.exchange(front, std::memory_order_acq_rel) & indexMask;
+		return true;
+	}
+
+	// consumer side
+	const T& read() const {
+		return buffers[front];
+	}
+};
+
+} // namespace miccontrol
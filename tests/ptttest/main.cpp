@@ -0,0 +1,158 @@
+#include "audiomanager/audiomanagerfake.h"
+#include "audiocommandworker.h"
+#include "inputrecording.h"
+#include "pttinputthread.h"
+#include "logging.h"
+#include <QCoreApplication>
+#include <QTemporaryDir>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+INITIALIZE_EASYLOGGINGPP
+
+using namespace miccontrol;
+
+
+// trigger presses of the right controller in the recording, press and release time in ms
+static const int triggerPresses[][2] = { { 50, 150 }, { 250, 300 }, { 400, 450 } };
+
+
+static bool writeRecording(const QString& path) {
+	InputRecorder recorder;
+	if (!recorder.open(path)) {
+		return false;
+	}
+	auto start = InputRecorder::Clock::now();
+	vr::VRControllerState_t state = vr::VRControllerState_t();
+	recorder.record(1, 1, start, state);
+	for (auto& press : triggerPresses) {
+		state.unPacketNum++;
+		state.ulButtonPressed = vr::ButtonMaskFromId(vr::k_EButton_SteamVR_Trigger);
+		state.rAxis[1].x = 1.0f;
+		recorder.record(1, 1, start + std::chrono::milliseconds(press[0]), state);
+		state.unPacketNum++;
+		state.ulButtonPressed = 0;
+		state.rAxis[1].x = 0.0f;
+		recorder.record(1, 1, start + std::chrono::milliseconds(press[1]), state);
+	}
+	recorder.close();
+	return true;
+}
+
+
+// Replays the recording through the push-to-talk input thread and checks the mute states that reached the fake
+// audio device: an unmute and a mute per press, in that order, and muted at the end.
+// With exact set every state must have been applied once, otherwise repetitions (retries, re-applies after a device
+// change) are fine.
+static bool runScenario(const char* name, const QString& recording, const std::string& fakeAudio, bool exact) {
+	auto fake = std::make_shared<AudioManagerFake>(FakeAudioConfig::parse(fakeAudio));
+	fake->init(nullptr);
+	fake->simulateExternalChange(true, 1.0f);
+	auto worker = std::make_shared<AudioCommandWorker>(fake);
+
+	std::unique_ptr<InputReplayer> replayer(new InputReplayer());
+	if (!replayer->open(recording)) {
+		std::printf("%s: FAILED, could not open the recording\n", name);
+		return false;
+	}
+	auto duration = std::chrono::nanoseconds(replayer->getDuration());
+
+	PttInputConfig config;
+	config.enabled = true;
+	config.rightControllerEnabled = true;
+	config.triggerModus = 1;
+	config.predicate.compile(config);
+	{
+		PttInputThread thread(worker, 1000);
+		thread.setReplayer(std::move(replayer));
+		thread.setConfig(config);
+		thread.start();
+		std::this_thread::sleep_for(duration + std::chrono::milliseconds(200));
+		thread.stop();
+		thread.wait();
+	}
+	worker.reset(); // executes the pending commands
+
+	std::vector<bool> expected;
+	for (size_t i = 0; i < sizeof(triggerPresses) / sizeof(triggerPresses[0]); i++) {
+		expected.push_back(false);
+		expected.push_back(true);
+	}
+	std::vector<bool> applied;
+	unsigned failures = 0;
+	unsigned rebinds = 0;
+	for (auto& call : fake->getCalls()) {
+		if (call.type == AudioManagerFake::CALL_SET_MUTED) {
+			bool muted = call.value != 0.0f;
+			if (!call.success) {
+				failures++;
+			} else if (exact || applied.empty() || applied.back() != muted) {
+				applied.push_back(muted);
+			}
+		} else if (call.type == AudioManagerFake::CALL_REBIND_DEVICE) {
+			rebinds++;
+		}
+	}
+
+	bool passed = applied == expected && fake->getCachedMuted();
+	std::printf("%s: %s, %u mute states applied (%u expected), %u failed calls, %u rebinds, %s at the end\n", name, passed ? "passed" : "FAILED",
+		(unsigned)applied.size(), (unsigned)expected.size(), failures, rebinds, fake->getCachedMuted() ? "muted" : "unmuted");
+	return passed;
+}
+
+
+// Without a log file only the most recent calls are kept.
+static bool testCallLimit() {
+	AudioManagerFake fake(FakeAudioConfig::parse("calls=4"));
+	fake.init(nullptr);
+	for (int i = 0; i < 10; i++) {
+		fake.setMasterVolume(i / 10.0f);
+	}
+	auto calls = fake.getCalls();
+	bool passed = calls.size() == 4 && fake.getDroppedCallCount() == 6 && calls.front().value == 0.6f && calls.back().value == 0.9f;
+	std::printf("call limit: %s, %u calls kept, %u dropped\n", passed ? "passed" : "FAILED", (unsigned)calls.size(), (unsigned)fake.getDroppedCallCount());
+	return passed;
+}
+
+
+// With a log file full buffers are written by the scheduler thread and writeCallLog() appends the rest, nothing is lost.
+static bool testCallLog(const QString& path) {
+	AudioManagerFake fake(FakeAudioConfig::parse("calls=4,log=" + path.toStdString()));
+	fake.init(nullptr);
+	for (int i = 0; i < 10; i++) {
+		fake.setMasterVolume(i / 10.0f);
+	}
+	bool written = fake.writeCallLog();
+	std::ifstream in(path.toStdString());
+	std::string line;
+	unsigned lines = 0;
+	while (std::getline(in, line)) {
+		lines++;
+	}
+	bool passed = written && lines == 11 && fake.getCalls().empty() && fake.getDroppedCallCount() == 0;
+	std::printf("call log: %s, %u lines written (11 expected)\n", passed ? "passed" : "FAILED", lines);
+	return passed;
+}
+
+
+int main(int argc, char* argv[]) {
+	QCoreApplication app(argc, argv);
+	QTemporaryDir dir;
+	QString recording = dir.path() + "/ptttest.mcir";
+	if (!dir.isValid() || !writeRecording(recording)) {
+		std::printf("FAILED: could not write the controller input recording\n");
+		return 1;
+	}
+
+	bool passed = testCallLimit();
+	passed &= testCallLog(dir.path() + "/calls.csv");
+	passed &= runScenario("replay", recording, "latency=1", true);
+	passed &= runScenario("replay with failing calls", recording, "latency=1,jitter=1,distribution=uniform,failure=0.3,seed=42", false);
+	passed &= runScenario("replay with device changes", recording, "latency=1,devicechange=20", false);
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,47 @@
+#-------------------------------------------------
+#
+# Headless push-to-talk test, replays recorded controller input against the fake audio backend
+#
+#-------------------------------------------------
+
+QT       = core
+
+TARGET = ptttest
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+SOURCES += main.cpp \
+		../../src/pttinputthread.cpp \
+		../../src/audiocommandworker.cpp \
+		../../src/audiomanager.cpp \
+		../../src/deadlinescheduler.cpp \
+		../../src/latencytracer.cpp \
+		../../src/pttpredicate.cpp \
+		../../src/inputrecording.cpp \
+		../../src/audiomanager/audiomanagerfake.cpp
+
+HEADERS  += ../../src/pttinputthread.h \
+		../../src/audiocommandworker.h \
+		../../src/audiomanager.h \
+		../../src/deadlinescheduler.h \
+		../../src/latencytracer.h \
+		../../src/pttpredicate.h \
+		../../src/inputrecording.h \
+		../../src/triplebuffer.h \
+		../../src/logging.h \
+		../../src/audiomanager/audiomanagerfake.h
+
+INCLUDEPATH += ../../src \
+			../../third-party/openvr/include \
+			../../third-party/easylogging++
+
+win32 {
+	LIBS += -L../../third-party/openvr/lib/win64 -lopenvr_api -lwinmm
+	DESTDIR = ../../bin/ptttest/win64
+}
+
+unix:!macx {
+	LIBS += -L../../third-party/openvr/lib/linux64 -lopenvr_api
+	DESTDIR = ../../bin/ptttest/linux64
+}
@@ -0,0 +1,128 @@
+#include "mockinterfaces.h"
+
+
+// mock runtime namespace
+namespace openvrmock {
+
+vr::EVRApplicationError MockVRApplications::AddApplicationManifest(const char* /*pchApplicationManifestFullPath*/, bool /*bTemporary*/) {
+	return vr::VRApplicationError_None;
+}
+
+vr::EVRApplicationError MockVRApplications::RemoveApplicationManifest(const char* /*pchApplicationManifestFullPath*/) {
+	return vr::VRApplicationError_None;
+}
+
+bool MockVRApplications::IsApplicationInstalled(const char* /*pchAppKey*/) {
+	// makes the application register its manifest on every start, which is harmless here
+	return false;
+}
+
+uint32_t MockVRApplications::GetApplicationCount() {
+	return 0;
+}
+
+vr::EVRApplicationError MockVRApplications::GetApplicationKeyByIndex(uint32_t /*unApplicationIndex*/, char* /*pchAppKeyBuffer*/, uint32_t /*unAppKeyBufferLen*/) {
+	return vr::VRApplicationError_UnknownApplication;
+}
+
+vr::EVRApplicationError MockVRApplications::GetApplicationKeyByProcessId(uint32_t /*unProcessId*/, char* /*pchAppKeyBuffer*/, uint32_t /*unAppKeyBufferLen*/) {
+	return vr::VRApplicationError_UnknownApplication;
+}
+
+vr::EVRApplicationError MockVRApplications::LaunchApplication(const char* /*pchAppKey*/) {
+	return vr::VRApplicationError_UnknownApplication;
+}
+
+vr::EVRApplicationError MockVRApplications::LaunchTemplateApplication(const char* /*pchTemplateAppKey*/, const char* /*pchNewAppKey*/, const vr::AppOverrideKeys_t* /*pKeys*/, uint32_t /*unKeys*/) {
+	return vr::VRApplicationError_UnknownApplication;
+}
+
+vr::EVRApplicationError MockVRApplications::LaunchApplicationFromMimeType(const char* /*pchMimeType*/, const char* /*pchArgs*/) {
+	return vr::VRApplicationError_UnknownApplication;
+}
+
+vr::EVRApplicationError MockVRApplications::LaunchDashboardOverlay(const char* /*pchAppKey*/) {
+	return vr::VRApplicationError_UnknownApplication;
+}
+
+bool MockVRApplications::CancelApplicationLaunch(const char* /*pchAppKey*/) {
+	return false;
+}
+
+vr::EVRApplicationError MockVRApplications::IdentifyApplication(uint32_t /*unProcessId*/, const char* /*pchAppKey*/) {
+	return vr::VRApplicationError_UnknownApplication;
+}
+
+uint32_t MockVRApplications::GetApplicationProcessId(const char* /*pchAppKey*/) {
+	return 0;
+}
+
+const char* MockVRApplications::GetApplicationsErrorNameFromEnum(vr::EVRApplicationError error) {
+	return error == vr::VRApplicationError_None ? "VRApplicationError_None" : "VRApplicationError_UnknownApplication";
+}
+
+uint32_t MockVRApplications::GetApplicationPropertyString(const char* /*pchAppKey*/, vr::EVRApplicationProperty /*eProperty*/, char* /*pchPropertyValueBuffer*/, uint32_t /*unPropertyValueBufferLen*/, vr::EVRApplicationError* /*peError*/) {
+	return 0;
+}
+
+bool MockVRApplications::GetApplicationPropertyBool(const char* /*pchAppKey*/, vr::EVRApplicationProperty /*eProperty*/, vr::EVRApplicationError* /*peError*/) {
+	return false;
+}
+
+uint64_t MockVRApplications::GetApplicationPropertyUint64(const char* /*pchAppKey*/, vr::EVRApplicationProperty /*eProperty*/, vr::EVRApplicationError* /*peError*/) {
+	return 0;
+}
+
+vr::EVRApplicationError MockVRApplications::SetApplicationAutoLaunch(const char* /*pchAppKey*/, bool /*bAutoLaunch*/) {
+	return vr::VRApplicationError_None;
+}
+
+bool MockVRApplications::GetApplicationAutoLaunch(const char* /*pchAppKey*/) {
+	return false;
+}
+
+vr::EVRApplicationError MockVRApplications::SetDefaultApplicationForMimeType(const char* /*pchAppKey*/, const char* /*pchMimeType*/) {
+	return vr::VRApplicationError_UnknownApplication;
+}
+
+bool MockVRApplications::GetDefaultApplicationForMimeType(const char* /*pchMimeType*/, char* /*pchAppKeyBuffer*/, uint32_t /*unAppKeyBufferLen*/) {
+	return false;
+}
+
+bool MockVRApplications::GetApplicationSupportedMimeTypes(const char* /*pchAppKey*/, char* /*pchMimeTypesBuffer*/, uint32_t /*unMimeTypesBuffer*/) {
+	return false;
+}
+
+uint32_t MockVRApplications::GetApplicationsThatSupportMimeType(const char* /*pchMimeType*/, char* /*pchAppKeysThatSupportBuffer*/, uint32_t /*unAppKeysThatSupportBuffer*/) {
+	return 0;
+}
+
+uint32_t MockVRApplications::GetApplicationLaunchArguments(uint32_t /*unHandle*/, char* /*pchArgs*/, uint32_t /*unArgs*/) {
+	return 0;
+}
+
+vr::EVRApplicationError MockVRApplications::GetStartingApplication(char* /*pchAppKeyBuffer*/, uint32_t /*unAppKeyBufferLen*/) {
+	return vr::VRApplicationError_UnknownApplication;
+}
+
+vr::EVRApplicationTransitionState MockVRApplications::GetTransitionState() {
+	return vr::VRApplicationTransition_None;
+}
+
+vr::EVRApplicationError MockVRApplications::PerformApplicationPrelaunchCheck(const char* /*pchAppKey*/) {
+	return vr::VRApplicationError_UnknownApplication;
+}
+
+const char* MockVRApplications::GetApplicationsTransitionStateNameFromEnum(vr::EVRApplicationTransitionState /*state*/) {
+	return "VRApplicationTransition_None";
+}
+
+bool MockVRApplications::IsQuitUserPromptRequested() {
+	return false;
+}
+
+vr::EVRApplicationError MockVRApplications::LaunchInternalProcess(const char* /*pchBinaryPath*/, const char* /*pchArguments*/, const char* /*pchWorkingDirectory*/) {
+	return vr::VRApplicationError_UnknownApplication;
+}
+
+}
@@ -0,0 +1,444 @@
+#include "mockinterfaces.h"
+#include "mockruntime.h"
+#include <cstring>
+
+
+// mock runtime namespace
+namespace openvrmock {
+
+vr::EVROverlayError MockVROverlay::FindOverlay(const char* pchOverlayKey, vr::VROverlayHandle_t* pOverlayHandle) {
+	auto& runtime = MockRuntime::instance();
+	std::lock_guard<std::recursive_mutex> lock(runtime.mutex);
+	for (auto& o : runtime.overlays) {
+		if (pchOverlayKey && o.second.key == pchOverlayKey) {
+			if (pOverlayHandle) {
+				*pOverlayHandle = o.first;
+			}
+			return vr::VROverlayError_None;
+		}
+	}
+	return vr::VROverlayError_UnknownOverlay;
+}
+
+vr::EVROverlayError MockVROverlay::CreateOverlay(const char* pchOverlayKey, const char* pchOverlayFriendlyName, vr::VROverlayHandle_t* pOverlayHandle) {
+	auto& runtime = MockRuntime::instance();
+	std::lock_guard<std::recursive_mutex> lock(runtime.mutex);
+	vr::VROverlayHandle_t existing;
+	if (!pchOverlayKey || !pchOverlayFriendlyName || !pOverlayHandle) {
+		return vr::VROverlayError_InvalidParameter;
+	} else if (FindOverlay(pchOverlayKey, &existing) == vr::VROverlayError_None) {
+		return vr::VROverlayError_KeyInUse;
+	}
+	*pOverlayHandle = runtime.createOverlay(pchOverlayKey, pchOverlayFriendlyName, false);
+	return vr::VROverlayError_None;
+}
+
+vr::EVROverlayError MockVROverlay::DestroyOverlay(vr::VROverlayHandle_t ulOverlayHandle) {
+	auto& runtime = MockRuntime::instance();
+	std::lock_guard<std::recursive_mutex> lock(runtime.mutex);
+	if (!runtime.overlays.erase(ulOverlayHandle)) {
+		return vr::VROverlayError_InvalidHandle;
+	}
+	if (runtime.inputOverlay == ulOverlayHandle) {
+		runtime.inputOverlay = vr::k_ulOverlayHandleInvalid;
+	}
+	return vr::VROverlayError_None;
+}
+
+vr::EVROverlayError MockVROverlay::SetHighQualityOverlay(vr::VROverlayHandle_t ulOverlayHandle) {
+	return overlayError(ulOverlayHandle);
+}
+
+vr::VROverlayHandle_t MockVROverlay::GetHighQualityOverlay() {
+	return vr::k_ulOverlayHandleInvalid;
+}
+
+uint32_t MockVROverlay::GetOverlayKey(vr::VROverlayHandle_t ulOverlayHandle, char* pchValue, uint32_t unBufferSize, vr::EVROverlayError* pError) {
+	auto& runtime = MockRuntime::instance();
+	std::lock_guard<std::recursive_mutex> lock(runtime.mutex);
+	auto overlay = runtime.findOverlay(ulOverlayHandle);
+	return copyString(overlay ? &overlay->key : nullptr, pchValue, unBufferSize, pError);
+}
+
+uint32_t MockVROverlay::GetOverlayName(vr::VROverlayHandle_t ulOverlayHandle, char* pchValue, uint32_t unBufferSize, vr::EVROverlayError* pError) {
+	auto& runtime = MockRuntime::instance();
+	std::lock_guard<std::recursive_mutex> lock(runtime.mutex);
+	auto overlay = runtime.findOverlay(ulOverlayHandle);
+	return copyString(overlay ? &overlay->name : nullptr, pchValue, unBufferSize, pError);
+}
+
+vr::EVROverlayError MockVROverlay::GetOverlayImageData(vr::VROverlayHandle_t /*ulOverlayHandle*/, void* /*pvBuffer*/, uint32_t /*unBufferSize*/, uint32_t* /*punWidth*/, uint32_t* /*punHeight*/) {
+	return vr::VROverlayError_RequestFailed;
+}
+
+const char* MockVROverlay::GetOverlayErrorNameFromEnum(vr::EVROverlayError error) {
+	switch (error) {
+		case vr::VROverlayError_None:
+			return "VROverlayError_None";
+		case vr::VROverlayError_UnknownOverlay:
+			return "VROverlayError_UnknownOverlay";
+		case vr::VROverlayError_InvalidHandle:
+			return "VROverlayError_InvalidHandle";
+		case vr::VROverlayError_WrongVisibilityType:
+			return "VROverlayError_WrongVisibilityType";
+		case vr::VROverlayError_KeyInUse:
+			return "VROverlayError_KeyInUse";
+		case vr::VROverlayError_InvalidParameter:
+			return "VROverlayError_InvalidParameter";
+		case vr::VROverlayError_RequestFailed:
+			return "VROverlayError_RequestFailed";
+		default:
+			return "VROverlayError_Unknown";
+	}
+}
+
+vr::EVROverlayError MockVROverlay::SetOverlayRenderingPid(vr::VROverlayHandle_t ulOverlayHandle, uint32_t /*unPID*/) {
+	return overlayError(ulOverlayHandle);
+}
+
+uint32_t MockVROverlay::GetOverlayRenderingPid(vr::VROverlayHandle_t /*ulOverlayHandle*/) {
+	return 0;
+}
+
+vr::EVROverlayError MockVROverlay::SetOverlayFlag(vr::VROverlayHandle_t ulOverlayHandle, vr::VROverlayFlags /*eOverlayFlag*/, bool /*bEnabled*/) {
+	return overlayError(ulOverlayHandle);
+}
+
+vr::EVROverlayError MockVROverlay::GetOverlayFlag(vr::VROverlayHandle_t /*ulOverlayHandle*/, vr::VROverlayFlags /*eOverlayFlag*/, bool* /*pbEnabled*/) {
+	return vr::VROverlayError_RequestFailed;
+}
+
+vr::EVROverlayError MockVROverlay::SetOverlayColor(vr::VROverlayHandle_t ulOverlayHandle, float /*fRed*/, float /*fGreen*/, float /*fBlue*/) {
+	return overlayError(ulOverlayHandle);
+}
+
+vr::EVROverlayError MockVROverlay::GetOverlayColor(vr::VROverlayHandle_t /*ulOverlayHandle*/, float* /*pfRed*/, float* /*pfGreen*/, float* /*pfBlue*/) {
+	return vr::VROverlayError_RequestFailed;
+}
+
+vr::EVROverlayError MockVROverlay::SetOverlayAlpha(vr::VROverlayHandle_t ulOverlayHandle, float /*fAlpha*/) {
+	return overlayError(ulOverlayHandle);
+}
+
+vr::EVROverlayError MockVROverlay::GetOverlayAlpha(vr::VROverlayHandle_t /*ulOverlayHandle*/, float* /*pfAlpha*/) {
+	return vr::VROverlayError_RequestFailed;
+}
+
+vr::EVROverlayError MockVROverlay::SetOverlayTexelAspect(vr::VROverlayHandle_t ulOverlayHandle, float /*fTexelAspect*/) {
+	return overlayError(ulOverlayHandle);
+}
+
+vr::EVROverlayError MockVROverlay::GetOverlayTexelAspect(vr::VROverlayHandle_t /*ulOverlayHandle*/, float* /*pfTexelAspect*/) {
+	return vr::VROverlayError_RequestFailed;
+}
+
+vr::EVROverlayError MockVROverlay::SetOverlaySortOrder(vr::VROverlayHandle_t ulOverlayHandle, uint32_t /*unSortOrder*/) {
+	return overlayError(ulOverlayHandle);
+}
+
+vr::EVROverlayError MockVROverlay::GetOverlaySortOrder(vr::VROverlayHandle_t /*ulOverlayHandle*/, uint32_t* /*punSortOrder*/) {
+	return vr::VROverlayError_RequestFailed;
+}
+
+vr::EVROverlayError MockVROverlay::SetOverlayWidthInMeters(vr::VROverlayHandle_t ulOverlayHandle, float /*fWidthInMeters*/) {
+	return overlayError(ulOverlayHandle);
+}
+
+vr::EVROverlayError MockVROverlay::GetOverlayWidthInMeters(vr::VROverlayHandle_t /*ulOverlayHandle*/, float* /*pfWidthInMeters*/) {
+	return vr::VROverlayError_RequestFailed;
+}
+
+vr::EVROverlayError MockVROverlay::SetOverlayAutoCurveDistanceRangeInMeters(vr::VROverlayHandle_t ulOverlayHandle, float /*fMinDistanceInMeters*/, float /*fMaxDistanceInMeters*/) {
+	return overlayError(ulOverlayHandle);
+}
+
+vr::EVROverlayError MockVROverlay::GetOverlayAutoCurveDistanceRangeInMeters(vr::VROverlayHandle_t /*ulOverlayHandle*/, float* /*pfMinDistanceInMeters*/, float* /*pfMaxDistanceInMeters*/) {
+	return vr::VROverlayError_RequestFailed;
+}
+
+vr::EVROverlayError MockVROverlay::SetOverlayTextureColorSpace(vr::VROverlayHandle_t ulOverlayHandle, vr::EColorSpace /*eTextureColorSpace*/) {
+	return overlayError(ulOverlayHandle);
+}
+
+vr::EVROverlayError MockVROverlay::GetOverlayTextureColorSpace(vr::VROverlayHandle_t /*ulOverlayHandle*/, vr::EColorSpace* /*peTextureColorSpace*/) {
+	return vr::VROverlayError_RequestFailed;
+}
+
+vr::EVROverlayError MockVROverlay::SetOverlayTextureBounds(vr::VROverlayHandle_t ulOverlayHandle, const vr::VRTextureBounds_t* /*pOverlayTextureBounds*/) {
+	return overlayError(ulOverlayHandle);
+}
+
+vr::EVROverlayError MockVROverlay::GetOverlayTextureBounds(vr::VROverlayHandle_t /*ulOverlayHandle*/, vr::VRTextureBounds_t* /*pOverlayTextureBounds*/) {
+	return vr::VROverlayError_RequestFailed;
+}
+
+vr::EVROverlayError MockVROverlay::GetOverlayTransformType(vr::VROverlayHandle_t /*ulOverlayHandle*/, vr::VROverlayTransformType* /*peTransformType*/) {
+	return vr::VROverlayError_RequestFailed;
+}
+
+vr::EVROverlayError MockVROverlay::SetOverlayTransformAbsolute(vr::VROverlayHandle_t ulOverlayHandle, vr::ETrackingUniverseOrigin /*eTrackingOrigin*/, const vr::HmdMatrix34_t* /*pmatTrackingOriginToOverlayTransform*/) {
+	return overlayError(ulOverlayHandle);
+}
+
+vr::EVROverlayError MockVROverlay::GetOverlayTransformAbsolute(vr::VROverlayHandle_t /*ulOverlayHandle*/, vr::ETrackingUniverseOrigin* /*peTrackingOrigin*/, vr::HmdMatrix34_t* /*pmatTrackingOriginToOverlayTransform*/) {
+	return vr::VROverlayError_RequestFailed;
+}
+
+vr::EVROverlayError MockVROverlay::SetOverlayTransformTrackedDeviceRelative(vr::VROverlayHandle_t ulOverlayHandle, vr::TrackedDeviceIndex_t /*unTrackedDevice*/, const vr::HmdMatrix34_t* /*pmatTrackedDeviceToOverlayTransform*/) {
+	return overlayError(ulOverlayHandle);
+}
+
+vr::EVROverlayError MockVROverlay::GetOverlayTransformTrackedDeviceRelative(vr::VROverlayHandle_t /*ulOverlayHandle*/, vr::TrackedDeviceIndex_t* /*punTrackedDevice*/, vr::HmdMatrix34_t* /*pmatTrackedDeviceToOverlayTransform*/) {
+	return vr::VROverlayError_RequestFailed;
+}
+
+vr::EVROverlayError MockVROverlay::SetOverlayTransformTrackedDeviceComponent(vr::VROverlayHandle_t ulOverlayHandle, vr::TrackedDeviceIndex_t /*unDeviceIndex*/, const char* /*pchComponentName*/) {
+	return overlayError(ulOverlayHandle);
+}
+
+vr::EVROverlayError MockVROverlay::GetOverlayTransformTrackedDeviceComponent(vr::VROverlayHandle_t /*ulOverlayHandle*/, vr::TrackedDeviceIndex_t* /*punDeviceIndex*/, char* /*pchComponentName*/, uint32_t /*unComponentNameSize*/) {
+	return vr::VROverlayError_RequestFailed;
+}
+
+vr::EVROverlayError MockVROverlay::ShowOverlay(vr::VROverlayHandle_t ulOverlayHandle) {
+	auto& runtime = MockRuntime::instance();
+	std::lock_guard<std::recursive_mutex> lock(runtime.mutex);
+	auto overlay = runtime.findOverlay(ulOverlayHandle);
+	if (!overlay) {
+		return vr::VROverlayError_InvalidHandle;
+	} else if (overlay->dashboard) {
+		return vr::VROverlayError_WrongVisibilityType;
+	}
+	runtime.setOverlayVisible(ulOverlayHandle, true);
+	return vr::VROverlayError_None;
+}
+
+vr::EVROverlayError MockVROverlay::HideOverlay(vr::VROverlayHandle_t ulOverlayHandle) {
+	auto& runtime = MockRuntime::instance();
+	std::lock_guard<std::recursive_mutex> lock(runtime.mutex);
+	auto overlay = runtime.findOverlay(ulOverlayHandle);
+	if (!overlay) {
+		return vr::VROverlayError_InvalidHandle;
+	} else if (overlay->dashboard) {
+		return vr::VROverlayError_WrongVisibilityType;
+	}
+	runtime.setOverlayVisible(ulOverlayHandle, false);
+	return vr::VROverlayError_None;
+}
+
+bool MockVROverlay::IsOverlayVisible(vr::VROverlayHandle_t ulOverlayHandle) {
+	auto& runtime = MockRuntime::instance();
+	std::lock_guard<std::recursive_mutex> lock(runtime.mutex);
+	runtime.advance();
+	auto overlay = runtime.findOverlay(ulOverlayHandle);
+	return overlay && overlay->visible;
+}
+
+vr::EVROverlayError MockVROverlay::GetTransformForOverlayCoordinates(vr::VROverlayHandle_t /*ulOverlayHandle*/, vr::ETrackingUniverseOrigin /*eTrackingOrigin*/, vr::HmdVector2_t /*coordinatesInOverlay*/, vr::HmdMatrix34_t* /*pmatTransform*/) {
+	return vr::VROverlayError_RequestFailed;
+}
+
+bool MockVROverlay::PollNextOverlayEvent(vr::VROverlayHandle_t ulOverlayHandle, vr::VREvent_t* pEvent, uint32_t uncbVREvent) {
+	auto& runtime = MockRuntime::instance();
+	std::lock_guard<std::recursive_mutex> lock(runtime.mutex);
+	runtime.advance();
+	auto overlay = runtime.findOverlay(ulOverlayHandle);
+	if (overlay && runtime.popEvent(overlay->events, pEvent, uncbVREvent)) {
+		runtime.stats.overlayEvents++;
+		return true;
+	}
+	return false;
+}
+
+vr::EVROverlayError MockVROverlay::GetOverlayInputMethod(vr::VROverlayHandle_t /*ulOverlayHandle*/, vr::VROverlayInputMethod* /*peInputMethod*/) {
+	return vr::VROverlayError_RequestFailed;
+}
+
+vr::EVROverlayError MockVROverlay::SetOverlayInputMethod(vr::VROverlayHandle_t ulOverlayHandle, vr::VROverlayInputMethod /*eInputMethod*/) {
+	return overlayError(ulOverlayHandle);
+}
+
+vr::EVROverlayError MockVROverlay::GetOverlayMouseScale(vr::VROverlayHandle_t /*ulOverlayHandle*/, vr::HmdVector2_t* /*pvecMouseScale*/) {
+	return vr::VROverlayError_RequestFailed;
+}
+
+vr::EVROverlayError MockVROverlay::SetOverlayMouseScale(vr::VROverlayHandle_t ulOverlayHandle, const vr::HmdVector2_t* /*pvecMouseScale*/) {
+	return overlayError(ulOverlayHandle);
+}
+
+bool MockVROverlay::ComputeOverlayIntersection(vr::VROverlayHandle_t /*ulOverlayHandle*/, const vr::VROverlayIntersectionParams_t* /*pParams*/, vr::VROverlayIntersectionResults_t* /*pResults*/) {
+	return false;
+}
+
+bool MockVROverlay::HandleControllerOverlayInteractionAsMouse(vr::VROverlayHandle_t /*ulOverlayHandle*/, vr::TrackedDeviceIndex_t /*unControllerDeviceIndex*/) {
+	return false;
+}
+
+bool MockVROverlay::IsHoverTargetOverlay(vr::VROverlayHandle_t /*ulOverlayHandle*/) {
+	return false;
+}
+
+vr::VROverlayHandle_t MockVROverlay::GetGamepadFocusOverlay() {
+	return vr::k_ulOverlayHandleInvalid;
+}
+
+vr::EVROverlayError MockVROverlay::SetGamepadFocusOverlay(vr::VROverlayHandle_t /*ulNewFocusOverlay*/) {
+	return vr::VROverlayError_RequestFailed;
+}
+
+vr::EVROverlayError MockVROverlay::SetOverlayNeighbor(vr::EOverlayDirection /*eDirection*/, vr::VROverlayHandle_t /*ulFrom*/, vr::VROverlayHandle_t /*ulTo*/) {
+	return vr::VROverlayError_RequestFailed;
+}
+
+vr::EVROverlayError MockVROverlay::MoveGamepadFocusToNeighbor(vr::EOverlayDirection /*eDirection*/, vr::VROverlayHandle_t /*ulFrom*/) {
+	return vr::VROverlayError_RequestFailed;
+}
+
+vr::EVROverlayError MockVROverlay::SetOverlayTexture(vr::VROverlayHandle_t ulOverlayHandle, const vr::Texture_t* pTexture) {
+	auto& runtime = MockRuntime::instance();
+	std::lock_guard<std::recursive_mutex> lock(runtime.mutex);
+	if (!runtime.findOverlay(ulOverlayHandle)) {
+		return vr::VROverlayError_InvalidHandle;
+	} else if (!pTexture) {
+		return vr::VROverlayError_InvalidTexture;
+	}
+	runtime.stats.textureSubmissions++;
+	return vr::VROverlayError_None;
+}
+
+vr::EVROverlayError MockVROverlay::ClearOverlayTexture(vr::VROverlayHandle_t ulOverlayHandle) {
+	return overlayError(ulOverlayHandle);
+}
+
+vr::EVROverlayError MockVROverlay::SetOverlayRaw(vr::VROverlayHandle_t ulOverlayHandle, void* pvBuffer, uint32_t unWidth, uint32_t unHeight, uint32_t unDepth) {
+	auto& runtime = MockRuntime::instance();
+	std::lock_guard<std::recursive_mutex> lock(runtime.mutex);
+	if (!runtime.findOverlay(ulOverlayHandle)) {
+		return vr::VROverlayError_InvalidHandle;
+	} else if (!pvBuffer || unWidth == 0 || unHeight == 0 || unDepth == 0 || unDepth > 4) {
+		return vr::VROverlayError_InvalidParameter;
+	}
+	runtime.stats.rawSubmissions++;
+	return vr::VROverlayError_None;
+}
+
+vr::EVROverlayError MockVROverlay::SetOverlayFromFile(vr::VROverlayHandle_t ulOverlayHandle, const char* pchFilePath) {
+	auto& runtime = MockRuntime::instance();
+	std::lock_guard<std::recursive_mutex> lock(runtime.mutex);
+	if (!runtime.findOverlay(ulOverlayHandle)) {
+		return vr::VROverlayError_InvalidHandle;
+	} else if (!pchFilePath) {
+		return vr::VROverlayError_InvalidParameter;
+	}
+	runtime.stats.fileSubmissions++;
+	return vr::VROverlayError_None;
+}
+
+vr::EVROverlayError MockVROverlay::GetOverlayTexture(vr::VROverlayHandle_t /*ulOverlayHandle*/, void** /*pNativeTextureHandle*/, void* /*pNativeTextureRef*/, uint32_t* /*pWidth*/, uint32_t* /*pHeight*/, uint32_t* /*pNativeFormat*/, vr::EGraphicsAPIConvention* /*pAPI*/, vr::EColorSpace* /*pColorSpace*/) {
+	return vr::VROverlayError_RequestFailed;
+}
+
+vr::EVROverlayError MockVROverlay::ReleaseNativeOverlayHandle(vr::VROverlayHandle_t /*ulOverlayHandle*/, void* /*pNativeTextureHandle*/) {
+	return vr::VROverlayError_RequestFailed;
+}
+
+vr::EVROverlayError MockVROverlay::GetOverlayTextureSize(vr::VROverlayHandle_t /*ulOverlayHandle*/, uint32_t* /*pWidth*/, uint32_t* /*pHeight*/) {
+	return vr::VROverlayError_RequestFailed;
+}
+
+vr::EVROverlayError MockVROverlay::CreateDashboardOverlay(const char* pchOverlayKey, const char* pchOverlayFriendlyName, vr::VROverlayHandle_t* pMainHandle, vr::VROverlayHandle_t* pThumbnailHandle) {
+	auto& runtime = MockRuntime::instance();
+	std::lock_guard<std::recursive_mutex> lock(runtime.mutex);
+	vr::VROverlayHandle_t existing;
+	if (!pchOverlayKey || !pchOverlayFriendlyName || !pMainHandle || !pThumbnailHandle) {
+		return vr::VROverlayError_InvalidParameter;
+	} else if (FindOverlay(pchOverlayKey, &existing) == vr::VROverlayError_None) {
+		return vr::VROverlayError_KeyInUse;
+	}
+	*pMainHandle = runtime.createOverlay(pchOverlayKey, pchOverlayFriendlyName, true);
+	*pThumbnailHandle = runtime.createOverlay(std::string(pchOverlayKey) + ".thumbnail", pchOverlayFriendlyName, true);
+	// scripted mouse events go to the most recently created dashboard overlay
+	runtime.inputOverlay = *pMainHandle;
+	return vr::VROverlayError_None;
+}
+
+bool MockVROverlay::IsDashboardVisible() {
+	auto& runtime = MockRuntime::instance();
+	std::lock_guard<std::recursive_mutex> lock(runtime.mutex);
+	runtime.advance();
+	return runtime.dashboardVisible;
+}
+
+bool MockVROverlay::IsActiveDashboardOverlay(vr::VROverlayHandle_t ulOverlayHandle) {
+	auto& runtime = MockRuntime::instance();
+	std::lock_guard<std::recursive_mutex> lock(runtime.mutex);
+	runtime.advance();
+	return runtime.dashboardVisible && runtime.inputOverlay == ulOverlayHandle;
+}
+
+vr::EVROverlayError MockVROverlay::SetDashboardOverlaySceneProcess(vr::VROverlayHandle_t ulOverlayHandle, uint32_t /*unProcessId*/) {
+	return overlayError(ulOverlayHandle);
+}
+
+vr::EVROverlayError MockVROverlay::GetDashboardOverlaySceneProcess(vr::VROverlayHandle_t /*ulOverlayHandle*/, uint32_t* /*punProcessId*/) {
+	return vr::VROverlayError_RequestFailed;
+}
+
+void MockVROverlay::ShowDashboard(const char* /*pchOverlayToShow*/) {
+	MockRuntime::instance().execute("dashboard show");
+}
+
+vr::TrackedDeviceIndex_t MockVROverlay::GetPrimaryDashboardDevice() {
+	return vr::k_unTrackedDeviceIndexInvalid;
+}
+
+vr::EVROverlayError MockVROverlay::ShowKeyboard(vr::EGamepadTextInputMode /*eInputMode*/, vr::EGamepadTextInputLineMode /*eLineInputMode*/, const char* /*pchDescription*/, uint32_t /*unCharMax*/, const char* /*pchExistingText*/, bool /*bUseMinimalMode*/, uint64_t /*uUserValue*/) {
+	return vr::VROverlayError_RequestFailed;
+}
+
+vr::EVROverlayError MockVROverlay::ShowKeyboardForOverlay(vr::VROverlayHandle_t /*ulOverlayHandle*/, vr::EGamepadTextInputMode /*eInputMode*/, vr::EGamepadTextInputLineMode /*eLineInputMode*/, const char* /*pchDescription*/, uint32_t /*unCharMax*/, const char* /*pchExistingText*/, bool /*bUseMinimalMode*/, uint64_t /*uUserValue*/) {
+	return vr::VROverlayError_RequestFailed;
+}
+
+uint32_t MockVROverlay::GetKeyboardText(char* pchText, uint32_t cchText) {
+	if (pchText && cchText > 0) {
+		pchText[0] = '\0';
+	}
+	return 1;
+}
+
+void MockVROverlay::HideKeyboard() {
+}
+
+void MockVROverlay::SetKeyboardTransformAbsolute(vr::ETrackingUniverseOrigin /*eTrackingOrigin*/, const vr::HmdMatrix34_t* /*pmatTrackingOriginToKeyboardTransform*/) {
+}
+
+void MockVROverlay::SetKeyboardPositionForOverlay(vr::VROverlayHandle_t /*ulOverlayHandle*/, vr::HmdRect2_t /*avoidRect*/) {
+}
+
+vr::EVROverlayError MockVROverlay::overlayError(vr::VROverlayHandle_t handle) {
+	auto& runtime = MockRuntime::instance();
+	std::lock_guard<std::recursive_mutex> lock(runtime.mutex);
+	return runtime.findOverlay(handle) ? vr::VROverlayError_None : vr::VROverlayError_InvalidHandle;
+}
+
+uint32_t MockVROverlay::copyString(const std::string* value, char* buffer, uint32_t size, vr::EVROverlayError* error) {
+	if (!value) {
+		if (error) {
+			*error = vr::VROverlayError_InvalidHandle;
+		}
+		return 0;
+	}
+	uint32_t required = (uint32_t)value->size() + 1;
+	if (buffer && size >= required) {
+		std::memcpy(buffer, value->c_str(), required);
+		if (error) {
+			*error = vr::VROverlayError_None;
+		}
+	} else if (error) {
+		*error = vr::VROverlayError_ArrayTooSmall;
+	}
+	return required;
+}
+
+}
@@ -0,0 +1,387 @@
+#include "mockruntime.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+
+// mock runtime namespace
+namespace openvrmock {
+
+namespace {
+
+struct ButtonName {
+	vr::EVRButtonId button;
+	const char* scriptName;
+	const char* enumName;
+};
+
+const ButtonName buttonNames[] = {
+	{ vr::k_EButton_System, "system", "k_EButton_System" },
+	{ vr::k_EButton_ApplicationMenu, "menu", "k_EButton_ApplicationMenu" },
+	{ vr::k_EButton_Grip, "grip", "k_EButton_Grip" },
+	{ vr::k_EButton_DPad_Left, "left", "k_EButton_DPad_Left" },
+	{ vr::k_EButton_DPad_Up, "up", "k_EButton_DPad_Up" },
+	{ vr::k_EButton_DPad_Right, "right", "k_EButton_DPad_Right" },
+	{ vr::k_EButton_DPad_Down, "down", "k_EButton_DPad_Down" },
+	{ vr::k_EButton_A, "a", "k_EButton_A" },
+	{ vr::k_EButton_Axis0, "touchpad", "k_EButton_SteamVR_Touchpad" },
+	{ vr::k_EButton_Axis1, "trigger", "k_EButton_SteamVR_Trigger" },
+	{ vr::k_EButton_Axis2, "axis2", "k_EButton_Axis2" },
+	{ vr::k_EButton_Axis3, "axis3", "k_EButton_Axis3" },
+	{ vr::k_EButton_Axis4, "axis4", "k_EButton_Axis4" },
+};
+
+bool parseHand(const std::string& name, vr::ETrackedControllerRole& role) {
+	if (name == "left") {
+		role = vr::TrackedControllerRole_LeftHand;
+	} else if (name == "right") {
+		role = vr::TrackedControllerRole_RightHand;
+	} else {
+		return false;
+	}
+	return true;
+}
+
+}
+
+
+MockRuntime& MockRuntime::instance() {
+	static MockRuntime runtime;
+	return runtime;
+}
+
+MockRuntime::MockRuntime() {
+	reset();
+}
+
+void MockRuntime::reset() {
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	initTime = Clock::now();
+	displayFrequency = 90.0f;
+	dashboardVisible = false;
+	// 0 is the HMD, both controllers are connected at start (scripts may disconnect them at 0 ms)
+	devices.clear();
+	devices.push_back({ vr::TrackedDeviceClass_HMD, vr::TrackedControllerRole_Invalid, true, {} });
+	devices.push_back({ vr::TrackedDeviceClass_Controller, vr::TrackedControllerRole_LeftHand, true, {} });
+	devices.push_back({ vr::TrackedDeviceClass_Controller, vr::TrackedControllerRole_RightHand, true, {} });
+	systemEvents.clear();
+	overlays.clear();
+	nextOverlayHandle = 1;
+	inputOverlay = vr::k_ulOverlayHandleInvalid;
+	stats = Stats();
+	script.clear();
+	scriptPosition = 0;
+	scriptOffset = 0.0;
+}
+
+bool MockRuntime::loadScript(const std::string& path) {
+	std::ifstream in(path);
+	if (!in) {
+		std::cerr << "[openvrmock] Could not open script " << path << "." << std::endl;
+		return false;
+	}
+	std::vector<Command> commands;
+	std::string line;
+	unsigned lineNumber = 0;
+	while (std::getline(in, line)) {
+		lineNumber++;
+		auto comment = line.find('#');
+		if (comment != std::string::npos) {
+			line.erase(comment);
+		}
+		std::istringstream fields(line);
+		Command command;
+		if (!(fields >> command.time)) {
+			if (line.find_first_not_of(" \t\r") != std::string::npos) {
+				std::cerr << "[openvrmock] " << path << ":" << lineNumber << ": missing time, line ignored." << std::endl;
+			}
+			continue;
+		}
+		std::getline(fields >> std::ws, command.line);
+		commands.push_back(command);
+	}
+	// commands with the same time keep their order
+	std::stable_sort(commands.begin(), commands.end(), [](const Command& a, const Command& b) {
+		return a.time < b.time;
+	});
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	script = std::move(commands);
+	scriptPosition = 0;
+	scriptOffset = 0.0;
+	std::cerr << "[openvrmock] Loaded " << script.size() << " script commands from " << path << "." << std::endl;
+	return true;
+}
+
+void MockRuntime::advance() {
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	double now = elapsed();
+	while (scriptPosition < script.size() && script[scriptPosition].time + scriptOffset <= now) {
+		const Command& command = script[scriptPosition++];
+		execute(command.line, command.time + scriptOffset);
+	}
+}
+
+bool MockRuntime::execute(const std::string& command, double dueTime) {
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	if (dueTime < 0.0) {
+		dueTime = elapsed();
+	}
+	stats.scriptCommands++;
+	std::istringstream args(command);
+	std::string name;
+	args >> name;
+	bool success = true;
+	if (name == "connect" || name == "disconnect" || name == "press" || name == "release"
+			|| name == "touch" || name == "untouch" || name == "axis") {
+		success = executeControllerCommand(name, args, dueTime);
+	} else if (name == "mouse") {
+		success = executeMouseCommand(args, dueTime);
+	} else if (name == "dashboard") {
+		std::string state;
+		args >> state;
+		if (state == "show" || state == "hide") {
+			setDashboardVisible(state == "show", dueTime);
+		} else {
+			success = false;
+		}
+	} else if (name == "frequency") {
+		float frequency = 0.0f;
+		success = (args >> frequency) && frequency > 0.0f;
+		if (success) {
+			displayFrequency = frequency;
+		}
+	} else if (name == "quit") {
+		queueSystemEvent(vr::VREvent_Quit, vr::k_unTrackedDeviceIndexInvalid, dueTime);
+		for (auto& o : overlays) {
+			queueOverlayEvent(o.first, vr::VREvent_Quit, dueTime);
+		}
+	} else if (name == "loop") {
+		// restart the script, its times are now relative to this command
+		if (dueTime > scriptOffset) {
+			scriptOffset = dueTime;
+			scriptPosition = 0;
+		} else {
+			std::cerr << "[openvrmock] Ignoring loop at the very start of the script." << std::endl;
+		}
+	} else {
+		success = false;
+	}
+	if (!success) {
+		std::cerr << "[openvrmock] Invalid command \"" << command << "\"." << std::endl;
+	}
+	return success;
+}
+
+bool MockRuntime::executeControllerCommand(const std::string& command, std::istream& args, double dueTime) {
+	std::string hand;
+	vr::ETrackedControllerRole role;
+	if (!(args >> hand) || !parseHand(hand, role)) {
+		return false;
+	}
+	vr::TrackedDeviceIndex_t index = role == vr::TrackedControllerRole_LeftHand ? 1 : 2;
+	Device& device = devices[index];
+	if (command == "connect" || command == "disconnect") {
+		bool connect = command == "connect";
+		if (device.connected != connect) {
+			device.connected = connect;
+			device.state = vr::VRControllerState_t();
+			queueSystemEvent(connect ? vr::VREvent_TrackedDeviceActivated : vr::VREvent_TrackedDeviceDeactivated, index, dueTime);
+		}
+		return true;
+	}
+	if (command == "axis") {
+		unsigned axis;
+		float x, y = 0.0f;
+		if (!(args >> axis >> x) || axis >= vr::k_unControllerStateAxisCount) {
+			return false;
+		}
+		args >> y;
+		device.state.rAxis[axis].x = x;
+		device.state.rAxis[axis].y = y;
+		device.state.unPacketNum++;
+		return true;
+	}
+	std::string buttonArg;
+	vr::EVRButtonId button;
+	if (!(args >> buttonArg) || !parseButton(buttonArg, button)) {
+		return false;
+	}
+	uint64_t mask = vr::ButtonMaskFromId(button);
+	vr::EVREventType type;
+	if (command == "press") {
+		device.state.ulButtonPressed |= mask;
+		type = vr::VREvent_ButtonPress;
+	} else if (command == "release") {
+		device.state.ulButtonPressed &= ~mask;
+		type = vr::VREvent_ButtonUnpress;
+	} else if (command == "touch") {
+		device.state.ulButtonTouched |= mask;
+		type = vr::VREvent_ButtonTouch;
+	} else {
+		device.state.ulButtonTouched &= ~mask;
+		type = vr::VREvent_ButtonUntouch;
+	}
+	device.state.unPacketNum++;
+	if (device.connected) {
+		vr::VREvent_Data_t data = {};
+		data.controller.button = button;
+		queueSystemEvent(type, index, dueTime, data);
+	}
+	return true;
+}
+
+bool MockRuntime::executeMouseCommand(std::istream& args, double dueTime) {
+	std::string action;
+	args >> action;
+	vr::VREvent_Data_t data = {};
+	if (action == "move") {
+		if (!(args >> data.mouse.x >> data.mouse.y)) {
+			return false;
+		}
+		queueOverlayEvent(inputOverlay, vr::VREvent_MouseMove, dueTime, data);
+		return true;
+	}
+	if (action != "down" && action != "up") {
+		return false;
+	}
+	std::string button = "left";
+	args >> button;
+	data.mouse.button = button == "right" ? vr::VRMouseButton_Right : vr::VRMouseButton_Left;
+	queueOverlayEvent(inputOverlay, action == "down" ? vr::VREvent_MouseButtonDown : vr::VREvent_MouseButtonUp, dueTime, data);
+	return true;
+}
+
+void MockRuntime::setDashboardVisible(bool visible, double dueTime) {
+	if (dashboardVisible == visible) {
+		return;
+	}
+	dashboardVisible = visible;
+	auto type = visible ? vr::VREvent_DashboardActivated : vr::VREvent_DashboardDeactivated;
+	queueSystemEvent(type, vr::k_unTrackedDeviceIndexInvalid, dueTime);
+	for (auto& o : overlays) {
+		queueOverlayEvent(o.first, type, dueTime);
+		if (o.second.dashboard) {
+			setOverlayVisible(o.first, visible, dueTime);
+		}
+	}
+}
+
+void MockRuntime::writeStats() {
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	std::ostringstream out;
+	out << "runtime_ms=" << elapsed() << "\n"
+		<< "system_events=" << stats.systemEvents << "\n"
+		<< "overlay_events=" << stats.overlayEvents << "\n"
+		<< "controller_state_queries=" << stats.controllerStateQueries << "\n"
+		<< "texture_submissions=" << stats.textureSubmissions << "\n"
+		<< "raw_submissions=" << stats.rawSubmissions << "\n"
+		<< "file_submissions=" << stats.fileSubmissions << "\n"
+		<< "script_commands=" << stats.scriptCommands << "\n";
+	std::cerr << "[openvrmock] Statistics:\n" << out.str() << std::flush;
+	const char* path = std::getenv("OPENVR_MOCK_STATS");
+	if (path && *path) {
+		std::ofstream file(path);
+		if (file) {
+			file << out.str();
+		} else {
+			std::cerr << "[openvrmock] Could not write statistics to " << path << "." << std::endl;
+		}
+	}
+}
+
+double MockRuntime::elapsed() {
+	return std::chrono::duration<double, std::milli>(Clock::now() - initTime).count();
+}
+
+vr::TrackedDeviceIndex_t MockRuntime::findDevice(vr::ETrackedControllerRole role) {
+	for (vr::TrackedDeviceIndex_t i = 0; i < devices.size(); i++) {
+		if (devices[i].connected && devices[i].role == role) {
+			return i;
+		}
+	}
+	return vr::k_unTrackedDeviceIndexInvalid;
+}
+
+MockRuntime::Overlay* MockRuntime::findOverlay(vr::VROverlayHandle_t handle) {
+	auto it = overlays.find(handle);
+	return it != overlays.end() ? &it->second : nullptr;
+}
+
+vr::VROverlayHandle_t MockRuntime::createOverlay(const std::string& key, const std::string& name, bool dashboard) {
+	vr::VROverlayHandle_t handle = nextOverlayHandle++;
+	Overlay& overlay = overlays[handle];
+	overlay.key = key;
+	overlay.name = name;
+	overlay.dashboard = dashboard;
+	overlay.visible = dashboard && dashboardVisible;
+	return handle;
+}
+
+MockRuntime::QueuedEvent MockRuntime::makeEvent(vr::EVREventType type, vr::TrackedDeviceIndex_t device, double dueTime, const vr::VREvent_Data_t& data) {
+	QueuedEvent queued;
+	queued.event.eventType = type;
+	queued.event.trackedDeviceIndex = device;
+	queued.event.eventAgeSeconds = 0.0f;
+	queued.event.data = data;
+	queued.dueTime = dueTime;
+	return queued;
+}
+
+void MockRuntime::queueSystemEvent(vr::EVREventType type, vr::TrackedDeviceIndex_t device, double dueTime, const vr::VREvent_Data_t& data) {
+	systemEvents.push_back(makeEvent(type, device, dueTime, data));
+}
+
+void MockRuntime::queueOverlayEvent(vr::VROverlayHandle_t handle, vr::EVREventType type, double dueTime, const vr::VREvent_Data_t& data) {
+	Overlay* overlay = findOverlay(handle);
+	if (overlay) {
+		overlay->events.push_back(makeEvent(type, vr::k_unTrackedDeviceIndexInvalid, dueTime, data));
+	}
+}
+
+bool MockRuntime::popEvent(std::deque<QueuedEvent>& queue, vr::VREvent_t* event, uint32_t size) {
+	if (queue.empty() || !event || size < sizeof(vr::VREvent_t)) {
+		return false;
+	}
+	*event = queue.front().event;
+	event->eventAgeSeconds = (float)std::max((elapsed() - queue.front().dueTime) / 1000.0, 0.0);
+	queue.pop_front();
+	return true;
+}
+
+void MockRuntime::setOverlayVisible(vr::VROverlayHandle_t handle, bool visible, double dueTime) {
+	Overlay* overlay = findOverlay(handle);
+	if (!overlay || overlay->visible == visible) {
+		return;
+	}
+	overlay->visible = visible;
+	queueOverlayEvent(handle, visible ? vr::VREvent_OverlayShown : vr::VREvent_OverlayHidden, dueTime < 0.0 ? elapsed() : dueTime);
+}
+
+const char* MockRuntime::buttonName(vr::EVRButtonId button) {
+	for (auto& b : buttonNames) {
+		if (b.button == button) {
+			return b.enumName;
+		}
+	}
+	return "Unknown EVRButtonId";
+}
+
+bool MockRuntime::parseButton(const std::string& name, vr::EVRButtonId& button) {
+	for (auto& b : buttonNames) {
+		if (name == b.scriptName) {
+			button = b.button;
+			return true;
+		}
+	}
+	char* end;
+	unsigned long id = std::strtoul(name.c_str(), &end, 10);
+	if (*end || end == name.c_str() || id >= vr::k_EButton_Max) {
+		return false;
+	}
+	button = (vr::EVRButtonId)id;
+	return true;
+}
+
+}
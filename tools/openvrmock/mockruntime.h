@@ -0,0 +1,107 @@
+#pragma once
+
+#include <openvr.h>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+// mock runtime namespace
+namespace openvrmock {
+
+// Everything the mocked interfaces share: tracked devices, overlays, event queues and the input script.
+// All members are guarded by mutex, the interfaces are called from the overlay controller's and the
+// push-to-talk input thread.
+class MockRuntime {
+public:
+	typedef std::chrono::steady_clock Clock;
+
+	struct Device {
+		vr::ETrackedDeviceClass deviceClass;
+		vr::ETrackedControllerRole role;
+		bool connected;
+		vr::VRControllerState_t state;
+	};
+
+	struct QueuedEvent {
+		vr::VREvent_t event;
+		double dueTime; // ms since init, the event age is derived from it when it is polled
+	};
+
+	struct Overlay {
+		std::string key;
+		std::string name;
+		bool dashboard; // main or thumbnail overlay of a dashboard overlay
+		bool visible;
+		std::deque<QueuedEvent> events;
+	};
+
+	struct Command {
+		double time; // ms since init
+		std::string line;
+	};
+
+	struct Stats {
+		uint64_t systemEvents = 0;
+		uint64_t overlayEvents = 0;
+		uint64_t controllerStateQueries = 0;
+		uint64_t textureSubmissions = 0; // SetOverlayTexture
+		uint64_t rawSubmissions = 0; // SetOverlayRaw
+		uint64_t fileSubmissions = 0; // SetOverlayFromFile
+		uint64_t scriptCommands = 0;
+	};
+
+	std::recursive_mutex mutex;
+	Clock::time_point initTime;
+	float displayFrequency = 90.0f;
+	bool dashboardVisible = false;
+	std::vector<Device> devices;
+	std::deque<QueuedEvent> systemEvents;
+	std::map<vr::VROverlayHandle_t, Overlay> overlays;
+	vr::VROverlayHandle_t nextOverlayHandle = 1;
+	vr::VROverlayHandle_t inputOverlay = vr::k_ulOverlayHandleInvalid; // receives scripted mouse events
+	Stats stats;
+
+private:
+	std::vector<Command> script;
+	size_t scriptPosition = 0;
+	double scriptOffset = 0.0; // ms, moved forward by "loop"
+
+public:
+	static MockRuntime& instance();
+
+	void reset();
+	// OPENVR_MOCK_SCRIPT, one "<ms> <command> [args]" per line, '#' starts a comment
+	bool loadScript(const std::string& path);
+	// applies all script commands which are due, called at the start of every polling interface method
+	void advance();
+	// executes a single command (without the leading time) right away
+	bool execute(const std::string& command, double dueTime = -1.0);
+	void writeStats();
+
+	double elapsed(); // ms since init
+	vr::TrackedDeviceIndex_t findDevice(vr::ETrackedControllerRole role);
+	Overlay* findOverlay(vr::VROverlayHandle_t handle);
+	vr::VROverlayHandle_t createOverlay(const std::string& key, const std::string& name, bool dashboard);
+
+	void queueSystemEvent(vr::EVREventType type, vr::TrackedDeviceIndex_t device, double dueTime, const vr::VREvent_Data_t& data = vr::VREvent_Data_t());
+	void queueOverlayEvent(vr::VROverlayHandle_t handle, vr::EVREventType type, double dueTime, const vr::VREvent_Data_t& data = vr::VREvent_Data_t());
+	bool popEvent(std::deque<QueuedEvent>& queue, vr::VREvent_t* event, uint32_t size);
+	void setOverlayVisible(vr::VROverlayHandle_t handle, bool visible, double dueTime = -1.0);
+
+	static const char* buttonName(vr::EVRButtonId button);
+
+private:
+	MockRuntime();
+
+	bool executeControllerCommand(const std::string& command, std::istream& args, double dueTime);
+	bool executeMouseCommand(std::istream& args, double dueTime);
+	void setDashboardVisible(bool visible, double dueTime);
+	QueuedEvent makeEvent(vr::EVREventType type, vr::TrackedDeviceIndex_t device, double dueTime, const vr::VREvent_Data_t& data);
+	static bool parseButton(const std::string& name, vr::EVRButtonId& button);
+};
+
+}
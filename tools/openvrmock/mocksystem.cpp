@@ -0,0 +1,272 @@
+#include "mockinterfaces.h"
+#include "mockruntime.h"
+#include <cmath>
+#include <cstring>
+
+
+// mock runtime namespace
+namespace openvrmock {
+
+void MockVRSystem::GetRecommendedRenderTargetSize(uint32_t* pnWidth, uint32_t* pnHeight) {
+	if (pnWidth) {
+		*pnWidth = 0;
+	}
+	if (pnHeight) {
+		*pnHeight = 0;
+	}
+}
+
+vr::HmdMatrix44_t MockVRSystem::GetProjectionMatrix(vr::EVREye /*eEye*/, float /*fNearZ*/, float /*fFarZ*/, vr::EGraphicsAPIConvention /*eProjType*/) {
+	return vr::HmdMatrix44_t();
+}
+
+void MockVRSystem::GetProjectionRaw(vr::EVREye /*eEye*/, float* /*pfLeft*/, float* /*pfRight*/, float* /*pfTop*/, float* /*pfBottom*/) {
+}
+
+vr::DistortionCoordinates_t MockVRSystem::ComputeDistortion(vr::EVREye /*eEye*/, float /*fU*/, float /*fV*/) {
+	return vr::DistortionCoordinates_t();
+}
+
+vr::HmdMatrix34_t MockVRSystem::GetEyeToHeadTransform(vr::EVREye /*eEye*/) {
+	return vr::HmdMatrix34_t();
+}
+
+bool MockVRSystem::GetTimeSinceLastVsync(float* pfSecondsSinceLastVsync, uint64_t* pulFrameCounter) {
+	// a display that runs with a perfectly steady frequency since init
+	auto& runtime = MockRuntime::instance();
+	std::lock_guard<std::recursive_mutex> lock(runtime.mutex);
+	runtime.advance();
+	double frameTime = 1000.0 / runtime.displayFrequency;
+	double elapsed = runtime.elapsed();
+	if (pfSecondsSinceLastVsync) {
+		*pfSecondsSinceLastVsync = (float)(std::fmod(elapsed, frameTime) / 1000.0);
+	}
+	if (pulFrameCounter) {
+		*pulFrameCounter = (uint64_t)(elapsed / frameTime);
+	}
+	return true;
+}
+
+int32_t MockVRSystem::GetD3D9AdapterIndex() {
+	return 0;
+}
+
+void MockVRSystem::GetDXGIOutputInfo(int32_t* /*pnAdapterIndex*/) {
+}
+
+bool MockVRSystem::IsDisplayOnDesktop() {
+	return false;
+}
+
+bool MockVRSystem::SetDisplayVisibility(bool /*bIsVisibleOnDesktop*/) {
+	return false;
+}
+
+void MockVRSystem::GetDeviceToAbsoluteTrackingPose(vr::ETrackingUniverseOrigin /*eOrigin*/, float /*fPredictedSecondsToPhotonsFromNow*/, vr::TrackedDevicePose_t* /*pTrackedDevicePoseArray*/, uint32_t /*unTrackedDevicePoseArrayCount*/) {
+}
+
+void MockVRSystem::ResetSeatedZeroPose() {
+}
+
+vr::HmdMatrix34_t MockVRSystem::GetSeatedZeroPoseToStandingAbsoluteTrackingPose() {
+	return vr::HmdMatrix34_t();
+}
+
+vr::HmdMatrix34_t MockVRSystem::GetRawZeroPoseToStandingAbsoluteTrackingPose() {
+	return vr::HmdMatrix34_t();
+}
+
+uint32_t MockVRSystem::GetSortedTrackedDeviceIndicesOfClass(vr::ETrackedDeviceClass eTrackedDeviceClass, vr::TrackedDeviceIndex_t* punTrackedDeviceIndexArray, uint32_t unTrackedDeviceIndexArrayCount, vr::TrackedDeviceIndex_t unRelativeToTrackedDeviceIndex) {
+	auto& runtime = MockRuntime::instance();
+	std::lock_guard<std::recursive_mutex> lock(runtime.mutex);
+	uint32_t count = 0;
+	for (vr::TrackedDeviceIndex_t i = 0; i < runtime.devices.size(); i++) {
+		auto& device = runtime.devices[i];
+		if (device.connected && device.deviceClass == eTrackedDeviceClass && i != unRelativeToTrackedDeviceIndex) {
+			if (punTrackedDeviceIndexArray && count < unTrackedDeviceIndexArrayCount) {
+				punTrackedDeviceIndexArray[count] = i;
+			}
+			count++;
+		}
+	}
+	return count;
+}
+
+vr::EDeviceActivityLevel MockVRSystem::GetTrackedDeviceActivityLevel(vr::TrackedDeviceIndex_t /*unDeviceId*/) {
+	return vr::k_EDeviceActivityLevel_UserInteraction;
+}
+
+void MockVRSystem::ApplyTransform(vr::TrackedDevicePose_t* /*pOutputPose*/, const vr::TrackedDevicePose_t* /*pTrackedDevicePose*/, const vr::HmdMatrix34_t* /*pTransform*/) {
+}
+
+vr::TrackedDeviceIndex_t MockVRSystem::GetTrackedDeviceIndexForControllerRole(vr::ETrackedControllerRole unDeviceType) {
+	auto& runtime = MockRuntime::instance();
+	std::lock_guard<std::recursive_mutex> lock(runtime.mutex);
+	runtime.advance();
+	return runtime.findDevice(unDeviceType);
+}
+
+vr::ETrackedControllerRole MockVRSystem::GetControllerRoleForTrackedDeviceIndex(vr::TrackedDeviceIndex_t unDeviceIndex) {
+	auto& runtime = MockRuntime::instance();
+	std::lock_guard<std::recursive_mutex> lock(runtime.mutex);
+	runtime.advance();
+	if (unDeviceIndex >= runtime.devices.size() || !runtime.devices[unDeviceIndex].connected) {
+		return vr::TrackedControllerRole_Invalid;
+	}
+	return runtime.devices[unDeviceIndex].role;
+}
+
+vr::ETrackedDeviceClass MockVRSystem::GetTrackedDeviceClass(vr::TrackedDeviceIndex_t unDeviceIndex) {
+	auto& runtime = MockRuntime::instance();
+	std::lock_guard<std::recursive_mutex> lock(runtime.mutex);
+	runtime.advance();
+	if (unDeviceIndex >= runtime.devices.size() || !runtime.devices[unDeviceIndex].connected) {
+		return vr::TrackedDeviceClass_Invalid;
+	}
+	return runtime.devices[unDeviceIndex].deviceClass;
+}
+
+bool MockVRSystem::IsTrackedDeviceConnected(vr::TrackedDeviceIndex_t unDeviceIndex) {
+	auto& runtime = MockRuntime::instance();
+	std::lock_guard<std::recursive_mutex> lock(runtime.mutex);
+	runtime.advance();
+	return unDeviceIndex < runtime.devices.size() && runtime.devices[unDeviceIndex].connected;
+}
+
+bool MockVRSystem::GetBoolTrackedDeviceProperty(vr::TrackedDeviceIndex_t /*unDeviceIndex*/, vr::ETrackedDeviceProperty /*prop*/, vr::ETrackedPropertyError* pError) {
+	if (pError) {
+		*pError = vr::TrackedProp_UnknownProperty;
+	}
+	return false;
+}
+
+float MockVRSystem::GetFloatTrackedDeviceProperty(vr::TrackedDeviceIndex_t unDeviceIndex, vr::ETrackedDeviceProperty prop, vr::ETrackedPropertyError* pError) {
+	auto& runtime = MockRuntime::instance();
+	std::lock_guard<std::recursive_mutex> lock(runtime.mutex);
+	if (unDeviceIndex == vr::k_unTrackedDeviceIndex_Hmd && prop == vr::Prop_DisplayFrequency_Float) {
+		if (pError) {
+			*pError = vr::TrackedProp_Success;
+		}
+		return runtime.displayFrequency;
+	}
+	if (pError) {
+		*pError = vr::TrackedProp_UnknownProperty;
+	}
+	return 0.0f;
+}
+
+int32_t MockVRSystem::GetInt32TrackedDeviceProperty(vr::TrackedDeviceIndex_t /*unDeviceIndex*/, vr::ETrackedDeviceProperty /*prop*/, vr::ETrackedPropertyError* pError) {
+	if (pError) {
+		*pError = vr::TrackedProp_UnknownProperty;
+	}
+	return 0;
+}
+
+uint64_t MockVRSystem::GetUint64TrackedDeviceProperty(vr::TrackedDeviceIndex_t /*unDeviceIndex*/, vr::ETrackedDeviceProperty /*prop*/, vr::ETrackedPropertyError* pError) {
+	if (pError) {
+		*pError = vr::TrackedProp_UnknownProperty;
+	}
+	return 0;
+}
+
+vr::HmdMatrix34_t MockVRSystem::GetMatrix34TrackedDeviceProperty(vr::TrackedDeviceIndex_t /*unDeviceIndex*/, vr::ETrackedDeviceProperty /*prop*/, vr::ETrackedPropertyError* pError) {
+	if (pError) {
+		*pError = vr::TrackedProp_UnknownProperty;
+	}
+	return vr::HmdMatrix34_t();
+}
+
+uint32_t MockVRSystem::GetStringTrackedDeviceProperty(vr::TrackedDeviceIndex_t /*unDeviceIndex*/, vr::ETrackedDeviceProperty /*prop*/, char* /*pchValue*/, uint32_t /*unBufferSize*/, vr::ETrackedPropertyError* pError) {
+	if (pError) {
+		*pError = vr::TrackedProp_UnknownProperty;
+	}
+	return 0;
+}
+
+const char* MockVRSystem::GetPropErrorNameFromEnum(vr::ETrackedPropertyError error) {
+	return error == vr::TrackedProp_Success ? "TrackedProp_Success" : "TrackedProp_UnknownProperty";
+}
+
+bool MockVRSystem::PollNextEvent(vr::VREvent_t* pEvent, uint32_t uncbVREvent) {
+	auto& runtime = MockRuntime::instance();
+	std::lock_guard<std::recursive_mutex> lock(runtime.mutex);
+	runtime.advance();
+	if (runtime.popEvent(runtime.systemEvents, pEvent, uncbVREvent)) {
+		runtime.stats.systemEvents++;
+		return true;
+	}
+	return false;
+}
+
+bool MockVRSystem::PollNextEventWithPose(vr::ETrackingUniverseOrigin /*eOrigin*/, vr::VREvent_t* pEvent, uint32_t uncbVREvent, vr::TrackedDevicePose_t* pTrackedDevicePose) {
+	if (pTrackedDevicePose) {
+		std::memset(pTrackedDevicePose, 0, sizeof(vr::TrackedDevicePose_t));
+	}
+	return PollNextEvent(pEvent, uncbVREvent);
+}
+
+const char* MockVRSystem::GetEventTypeNameFromEnum(vr::EVREventType /*eType*/) {
+	return "VREvent";
+}
+
+vr::HiddenAreaMesh_t MockVRSystem::GetHiddenAreaMesh(vr::EVREye /*eEye*/) {
+	return vr::HiddenAreaMesh_t();
+}
+
+bool MockVRSystem::GetControllerState(vr::TrackedDeviceIndex_t unControllerDeviceIndex, vr::VRControllerState_t* pControllerState) {
+	auto& runtime = MockRuntime::instance();
+	std::lock_guard<std::recursive_mutex> lock(runtime.mutex);
+	runtime.advance();
+	runtime.stats.controllerStateQueries++;
+	if (unControllerDeviceIndex >= runtime.devices.size() || !runtime.devices[unControllerDeviceIndex].connected
+			|| runtime.devices[unControllerDeviceIndex].deviceClass != vr::TrackedDeviceClass_Controller || !pControllerState) {
+		return false;
+	}
+	*pControllerState = runtime.devices[unControllerDeviceIndex].state;
+	return true;
+}
+
+bool MockVRSystem::GetControllerStateWithPose(vr::ETrackingUniverseOrigin /*eOrigin*/, vr::TrackedDeviceIndex_t unControllerDeviceIndex, vr::VRControllerState_t* pControllerState, vr::TrackedDevicePose_t* pTrackedDevicePose) {
+	if (pTrackedDevicePose) {
+		std::memset(pTrackedDevicePose, 0, sizeof(vr::TrackedDevicePose_t));
+	}
+	return GetControllerState(unControllerDeviceIndex, pControllerState);
+}
+
+void MockVRSystem::TriggerHapticPulse(vr::TrackedDeviceIndex_t /*unControllerDeviceIndex*/, uint32_t /*unAxisId*/, unsigned short /*usDurationMicroSec*/) {
+}
+
+const char* MockVRSystem::GetButtonIdNameFromEnum(vr::EVRButtonId eButtonId) {
+	return MockRuntime::buttonName(eButtonId);
+}
+
+const char* MockVRSystem::GetControllerAxisTypeNameFromEnum(vr::EVRControllerAxisType /*eAxisType*/) {
+	return "k_eControllerAxis_None";
+}
+
+bool MockVRSystem::CaptureInputFocus() {
+	return false;
+}
+
+void MockVRSystem::ReleaseInputFocus() {
+}
+
+bool MockVRSystem::IsInputFocusCapturedByAnotherProcess() {
+	return false;
+}
+
+uint32_t MockVRSystem::DriverDebugRequest(vr::TrackedDeviceIndex_t /*unDeviceIndex*/, const char* /*pchRequest*/, char* /*pchResponseBuffer*/, uint32_t /*unResponseBufferSize*/) {
+	return 0;
+}
+
+vr::EVRFirmwareError MockVRSystem::PerformFirmwareUpdate(vr::TrackedDeviceIndex_t /*unDeviceIndex*/) {
+	return vr::VRFirmwareError_Fail;
+}
+
+void MockVRSystem::AcknowledgeQuit_Exiting() {
+}
+
+void MockVRSystem::AcknowledgeQuit_UserPrompt() {
+}
+
+}
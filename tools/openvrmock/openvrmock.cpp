@@ -0,0 +1,155 @@
+#include "openvrmock.h"
+#include "mockinterfaces.h"
+#include "mockruntime.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+
+// mock runtime namespace
+namespace openvrmock {
+
+namespace {
+
+MockVRSystem vrSystem;
+MockVRApplications vrApplications;
+MockVROverlay vrOverlay;
+
+uint32_t initToken = 0;
+bool initialized = false;
+
+void writeStatsAtExit() {
+	// the application may exit without calling VR_Shutdown()
+	if (initialized) {
+		MockRuntime::instance().writeStats();
+	}
+}
+
+}
+
+}
+
+
+using namespace openvrmock;
+
+VR_INTERFACE uint32_t VR_CALLTYPE VR_InitInternal(vr::EVRInitError* peError, vr::EVRApplicationType eApplicationType) {
+	const char* initError = std::getenv("OPENVR_MOCK_INIT_ERROR");
+	if (initError && *initError && std::atoi(initError) != vr::VRInitError_None) {
+		if (peError) {
+			*peError = (vr::EVRInitError)std::atoi(initError);
+		}
+		return initToken;
+	}
+	if (!initialized) {
+		// construct the runtime first, it has to outlive the exit handler
+		auto& runtime = MockRuntime::instance();
+		static bool atExitRegistered = false;
+		if (!atExitRegistered) {
+			std::atexit(writeStatsAtExit);
+			atExitRegistered = true;
+		}
+		runtime.reset();
+		const char* script = std::getenv("OPENVR_MOCK_SCRIPT");
+		if (script && *script) {
+			runtime.loadScript(script);
+		}
+		initialized = true;
+		initToken++;
+		std::cerr << "[openvrmock] Initialized mock runtime for application type " << eApplicationType << "." << std::endl;
+	}
+	if (peError) {
+		*peError = vr::VRInitError_None;
+	}
+	return initToken;
+}
+
+VR_INTERFACE void VR_CALLTYPE VR_ShutdownInternal() {
+	if (initialized) {
+		MockRuntime::instance().writeStats();
+		initialized = false;
+		initToken++;
+	}
+}
+
+VR_INTERFACE bool VR_CALLTYPE VR_IsHmdPresent() {
+	return true;
+}
+
+VR_INTERFACE bool VR_CALLTYPE VR_IsRuntimeInstalled() {
+	return true;
+}
+
+VR_INTERFACE const char* VR_CALLTYPE VR_RuntimePath() {
+	return "";
+}
+
+VR_INTERFACE const char* VR_CALLTYPE VR_GetVRInitErrorAsSymbol(vr::EVRInitError error) {
+	switch (error) {
+		case vr::VRInitError_None:
+			return "VRInitError_None";
+		case vr::VRInitError_Init_InterfaceNotFound:
+			return "VRInitError_Init_InterfaceNotFound";
+		case vr::VRInitError_Init_NotInitialized:
+			return "VRInitError_Init_NotInitialized";
+		default:
+			return "VRInitError_Unknown";
+	}
+}
+
+VR_INTERFACE const char* VR_CALLTYPE VR_GetVRInitErrorAsEnglishDescription(vr::EVRInitError error) {
+	switch (error) {
+		case vr::VRInitError_None:
+			return "No Error (0)";
+		case vr::VRInitError_Init_InterfaceNotFound:
+			return "Interface not supported by the mock runtime (105)";
+		case vr::VRInitError_Init_NotInitialized:
+			return "Mock runtime not initialized (109)";
+		default:
+			return "Initialization error injected through OPENVR_MOCK_INIT_ERROR";
+	}
+}
+
+VR_INTERFACE void* VR_CALLTYPE VR_GetGenericInterface(const char* pchInterfaceVersion, vr::EVRInitError* peError) {
+	void* result = nullptr;
+	vr::EVRInitError error = vr::VRInitError_None;
+	if (!initialized) {
+		error = vr::VRInitError_Init_NotInitialized;
+	} else if (!pchInterfaceVersion) {
+		error = vr::VRInitError_Init_InterfaceNotFound;
+	} else if (std::strcmp(pchInterfaceVersion, vr::IVRSystem_Version) == 0) {
+		result = static_cast<vr::IVRSystem*>(&vrSystem);
+	} else if (std::strcmp(pchInterfaceVersion, vr::IVRApplications_Version) == 0) {
+		result = static_cast<vr::IVRApplications*>(&vrApplications);
+	} else if (std::strcmp(pchInterfaceVersion, vr::IVROverlay_Version) == 0) {
+		result = static_cast<vr::IVROverlay*>(&vrOverlay);
+	} else {
+		error = vr::VRInitError_Init_InterfaceNotFound;
+	}
+	if (peError) {
+		*peError = error;
+	}
+	return result;
+}
+
+VR_INTERFACE bool VR_CALLTYPE VR_IsInterfaceVersionValid(const char* pchInterfaceVersion) {
+	return pchInterfaceVersion && (std::strcmp(pchInterfaceVersion, vr::IVRSystem_Version) == 0
+		|| std::strcmp(pchInterfaceVersion, vr::IVRApplications_Version) == 0
+		|| std::strcmp(pchInterfaceVersion, vr::IVROverlay_Version) == 0);
+}
+
+VR_INTERFACE uint32_t VR_CALLTYPE VR_GetInitToken() {
+	return initToken;
+}
+
+
+OPENVR_MOCK_API bool OpenVRMock_LoadScript(const char* path) {
+	return path && MockRuntime::instance().loadScript(path);
+}
+
+OPENVR_MOCK_API bool OpenVRMock_Execute(const char* command) {
+	return command && MockRuntime::instance().execute(command);
+}
+
+OPENVR_MOCK_API void OpenVRMock_WriteStats() {
+	MockRuntime::instance().writeStats();
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+// Control interface of the mock OpenVR runtime for test drivers that run in the same process as the application.
+// Everything else is configured through environment variables when VR_Init() is called:
+//   OPENVR_MOCK_SCRIPT      input script, see Readme.md
+//   OPENVR_MOCK_STATS       file the statistics are written to on VR_Shutdown() or exit
+//   OPENVR_MOCK_INIT_ERROR  numeric vr::EVRInitError VR_Init() fails with
+
+#if defined(_WIN32)
+#ifdef VR_API_EXPORT
+#define OPENVR_MOCK_API extern "C" __declspec( dllexport )
+#else
+#define OPENVR_MOCK_API extern "C" __declspec( dllimport )
+#endif
+#else
+#define OPENVR_MOCK_API extern "C" __attribute__((visibility("default")))
+#endif
+
+// replaces the current script, its times are relative to VR_Init()
+OPENVR_MOCK_API bool OpenVRMock_LoadScript(const char* path);
+// executes a script command (without the leading time) right away, e.g. "press right trigger"
+OPENVR_MOCK_API bool OpenVRMock_Execute(const char* command);
+OPENVR_MOCK_API void OpenVRMock_WriteStats();
@@ -0,0 +1,34 @@
+#-------------------------------------------------
+#
+# Mock OpenVR runtime, a drop-in replacement for libopenvr_api / openvr_api.dll
+#
+#-------------------------------------------------
+
+QT       -= core gui
+
+TARGET = openvr_api
+TEMPLATE = lib
+CONFIG += plugin c++11
+
+DEFINES += VR_API_EXPORT
+
+SOURCES += openvrmock.cpp \
+		mockruntime.cpp \
+		mocksystem.cpp \
+		mockapplications.cpp \
+		mockoverlay.cpp
+
+HEADERS  += openvrmock.h \
+		mockruntime.h \
+		mockinterfaces.h
+
+INCLUDEPATH += ../../third-party/openvr/include
+
+win32 {
+	DESTDIR = ../../bin/openvrmock/win64
+}
+
+unix:!macx {
+	QMAKE_CXXFLAGS += -fvisibility=hidden
+	DESTDIR = ../../bin/openvrmock/linux64
+}
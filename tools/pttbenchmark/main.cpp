@@ -0,0 +1,167 @@
+#include "pttinputthread.h"
+#include "pttpredicate.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace miccontrol;
+
+
+// The binding evaluation as it was before the predicate got compiled into a table, kept verbatim as reference.
+static bool legacyEvaluate(const vr::VRControllerState_t& state, const PttInputConfig& config) {
+	if (state.ulButtonPressed & config.digitalButtonMask) {
+		return true;
+	}
+	if (config.triggerModus) {
+		if ( state.ulButtonPressed & vr::ButtonMaskFromId(vr::k_EButton_SteamVR_Trigger)
+			|| state.ulButtonTouched & vr::ButtonMaskFromId(vr::k_EButton_SteamVR_Trigger) ) {
+			return true;
+		}
+	}
+	if (config.padModus) {
+		if ( ( (config.padModus & 1) && (state.ulButtonTouched & vr::ButtonMaskFromId(vr::k_EButton_SteamVR_Touchpad)) )
+				|| ( (config.padModus & 2) && (state.ulButtonPressed & vr::ButtonMaskFromId(vr::k_EButton_SteamVR_Touchpad)) ) ) {
+			if (config.padArea == (PttInputConfig::PAD_AREA_LEFT + PttInputConfig::PAD_AREA_TOP + PttInputConfig::PAD_AREA_RIGHT + PttInputConfig::PAD_AREA_BOTTOM)) {
+				return true;
+			} else {
+				float x = state.rAxis[0].x;
+				float y = state.rAxis[0].y;
+				if (std::abs(x) >= 0.2 || std::abs(y) >= 0.2) { // deadzone in the middle
+					if (x < 0 && std::abs(y) < -x && (config.padArea & PttInputConfig::PAD_AREA_LEFT)) {
+						return true;
+					} else if (y > 0 && std::abs(x) < y && (config.padArea & PttInputConfig::PAD_AREA_TOP)) {
+						return true;
+					} else if (x > 0 && std::abs(y) < x && (config.padArea & PttInputConfig::PAD_AREA_RIGHT)) {
+						return true;
+					} else if (y < 0 && std::abs(x) < -y && (config.padArea & PttInputConfig::PAD_AREA_BOTTOM)) {
+						return true;
+					}
+				}
+			}
+		}
+	}
+	return false;
+}
+
+
+// The table classifies the center of each cell, so results may only differ in cells cut by an area boundary.
+static bool nearBoundary(const vr::VRControllerState_t& state, const PttInputConfig& config) {
+	const float cellSize = 2.0f / PttPredicate::padGridSize;
+	float x = std::abs(state.rAxis[0].x);
+	float y = std::abs(state.rAxis[0].y);
+	return std::abs(x - y) < cellSize || std::abs(std::max(x, y) - config.padInnerRadius) < cellSize;
+}
+
+
+static std::vector<vr::VRControllerState_t> randomStates(size_t count) {
+	const uint64_t buttons[] = {
+		vr::ButtonMaskFromId(vr::k_EButton_Grip),
+		vr::ButtonMaskFromId(vr::k_EButton_ApplicationMenu),
+		vr::ButtonMaskFromId(vr::k_EButton_SteamVR_Trigger),
+		vr::ButtonMaskFromId(vr::k_EButton_SteamVR_Touchpad)
+	};
+	std::mt19937 random(42);
+	std::uniform_real_distribution<float> axis(-1.0f, 1.0f);
+	std::uniform_int_distribution<int> bits(0, 15);
+	std::vector<vr::VRControllerState_t> states(count);
+	for (size_t i = 0; i < count; i++) {
+		vr::VRControllerState_t& state = states[i];
+		state = vr::VRControllerState_t();
+		state.unPacketNum = (uint32_t)i;
+		int pressed = bits(random);
+		int touched = bits(random) | pressed;
+		for (int b = 0; b < 4; b++) {
+			if (pressed & (1 << b)) {
+				state.ulButtonPressed |= buttons[b];
+			}
+			if (touched & (1 << b)) {
+				state.ulButtonTouched |= buttons[b];
+			}
+		}
+		state.rAxis[0].x = axis(random);
+		state.rAxis[0].y = axis(random);
+		state.rAxis[1].x = (axis(random) + 1.0f) / 2.0f;
+	}
+	return states;
+}
+
+
+int main(int argc, char* argv[]) {
+	size_t sampleCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+	unsigned repetitions = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 20;
+	std::vector<vr::VRControllerState_t> states = randomStates(sampleCount);
+
+	uint64_t evaluations = 0;
+	uint64_t mismatches = 0;
+	uint64_t boundaryMismatches = 0;
+	double legacyTime = 0.0;
+	double compiledTime = 0.0;
+	unsigned sink = 0;
+	// every combination of the UI's touchpad area and mode toggles, as the UI configures them
+	for (int padModus = 1; padModus <= 3; padModus++) {
+		for (int padArea = 1; padArea <= 15; padArea++) {
+			PttInputConfig config;
+			config.enabled = true;
+			config.digitalButtonMask = vr::ButtonMaskFromId(vr::k_EButton_Grip);
+			config.triggerModus = padArea & 1;
+			config.padModus = padModus;
+			config.padArea = padArea;
+			config.padSectorCount = 4;
+			config.padSectorMask = PttPredicate::sectorMaskFromPadArea(padArea, 4);
+			config.padInnerArea = padArea == PttInputConfig::PAD_AREA_ALL;
+			// the original evaluation had no hysteresis
+			config.padSectorHysteresis = 0.0f;
+			config.padRadialHysteresis = 0.0f;
+			config.predicate.compile(config);
+
+			for (const auto& state : states) {
+				uint8_t padSector = PttPredicate::padSectorNone;
+				if (legacyEvaluate(state, config) != config.predicate.evaluate(state, padSector)) {
+					mismatches++;
+					if (nearBoundary(state, config)) {
+						boundaryMismatches++;
+					} else if (mismatches - boundaryMismatches <= 10) {
+						std::printf("padModus=%d padArea=%d x=%f y=%f pressed=%llx touched=%llx: results differ\n", padModus, padArea,
+							state.rAxis[0].x, state.rAxis[0].y, (unsigned long long)state.ulButtonPressed, (unsigned long long)state.ulButtonTouched);
+					}
+				}
+			}
+			evaluations += states.size();
+
+			auto start = std::chrono::steady_clock::now();
+			for (unsigned r = 0; r < repetitions; r++) {
+				for (const auto& state : states) {
+					sink += legacyEvaluate(state, config);
+				}
+			}
+			auto middle = std::chrono::steady_clock::now();
+			for (unsigned r = 0; r < repetitions; r++) {
+				uint8_t padSector = PttPredicate::padSectorNone;
+				for (const auto& state : states) {
+					sink += config.predicate.evaluate(state, padSector);
+				}
+			}
+			auto end = std::chrono::steady_clock::now();
+			legacyTime += std::chrono::duration<double, std::nano>(middle - start).count();
+			compiledTime += std::chrono::duration<double, std::nano>(end - middle).count();
+		}
+	}
+	// keeps the compiler from dropping the loops
+	volatile unsigned keep = sink;
+	(void)keep;
+
+	double timedEvaluations = (double)evaluations * repetitions;
+	std::printf("legacy evaluation:   %.2f ns\n", legacyTime / timedEvaluations);
+	std::printf("compiled predicate:  %.2f ns\n", compiledTime / timedEvaluations);
+	std::printf("results differ for %llu of %llu samples (%.3f%%), %llu of them within one table cell of an area boundary\n",
+		(unsigned long long)mismatches, (unsigned long long)evaluations, 100.0 * mismatches / evaluations, (unsigned long long)boundaryMismatches);
+	if (mismatches != boundaryMismatches) {
+		std::printf("FAILED: the compiled predicate disagrees away from the area boundaries\n");
+		return 1;
+	}
+	return 0;
+}
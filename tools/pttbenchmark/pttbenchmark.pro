@@ -0,0 +1,29 @@
+#-------------------------------------------------
+#
+# Push-to-talk predicate benchmark, compares the compiled predicate with the original binding evaluation
+#
+#-------------------------------------------------
+
+QT       = core
+
+TARGET = pttbenchmark
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+SOURCES += main.cpp \
+		../../src/pttpredicate.cpp
+
+HEADERS  += ../../src/pttpredicate.h
+
+INCLUDEPATH += ../../src \
+			../../third-party/openvr/include \
+			../../third-party/easylogging++
+
+win32 {
+	DESTDIR = ../../bin/pttbenchmark/win64
+}
+
+unix:!macx {
+	DESTDIR = ../../bin/pttbenchmark/linux64
+}